@@ -32,7 +32,7 @@ public class GEEquip : ModuleRules
         PrivateDependencyModuleNames.AddRange(
             new string[]
             {
-                "NetCore",
+                "NetCore", "DeveloperSettings",
             }
         );
 
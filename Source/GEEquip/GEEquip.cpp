@@ -2,13 +2,32 @@
 
 #include "GEEquip.h"
 
+#include "Equipment/Equipment.h"
+#include "Type/EquipmentSlotTypes.h"
+
 IMPLEMENT_MODULE(FGEEquipModule, GEEquip)
 
 
 void FGEEquipModule::StartupModule()
 {
+	FEquipmentSlotIndexRegistry::Get().Startup();
+
+#if WITH_EDITOR
+	// Fragment classes may have been recompiled, so rebuild execution plans of equipment
+
+	ObjectsReplacedHandle = FCoreUObjectDelegates::OnObjectsReplaced.AddLambda(
+		[](const TMap<UObject*, UObject*>&)
+		{
+			UEquipment::InvalidateExecutionPlans();
+		});
+#endif
 }
 
 void FGEEquipModule::ShutdownModule()
 {
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectsReplaced.Remove(ObjectsReplacedHandle);
+#endif
+
+	FEquipmentSlotIndexRegistry::Get().Shutdown();
 }
@@ -14,4 +14,9 @@ public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 
+#if WITH_EDITOR
+private:
+	FDelegateHandle ObjectsReplacedHandle;
+#endif
+
 };
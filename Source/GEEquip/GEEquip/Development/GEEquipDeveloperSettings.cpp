@@ -0,0 +1,14 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "GEEquipDeveloperSettings.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GEEquipDeveloperSettings)
+
+
+UGEEquipDeveloperSettings::UGEEquipDeveloperSettings()
+{
+	CategoryName = TEXT("Plugins");
+	SectionName = TEXT("Game Equipment Extension");
+
+	ItemAssetTypes.Add(FPrimaryAssetType(TEXT("ItemData")));
+}
@@ -0,0 +1,79 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Engine/DeveloperSettings.h"
+
+#include "UObject/PrimaryAssetId.h"
+
+#include "GEEquipDeveloperSettings.generated.h"
+
+class UEquipmentCatalog;
+
+
+/**
+ * Settings for the Game Equipment Extension plugin
+ */
+UCLASS(Config = "Game", Defaultconfig, meta = (DisplayName = "Game Equipment Extension"))
+class GEEQUIP_API UGEEquipDeveloperSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+public:
+	UGEEquipDeveloperSettings();
+
+	///////////////////////////////////////////////
+	// Asset Registry
+public:
+	//
+	// Primary asset types of item data scanned for equipment items
+	//
+	UPROPERTY(Config, EditAnywhere, Category = "Asset Registry")
+	TArray<FPrimaryAssetType> ItemAssetTypes;
+
+	//
+	// Whether to scan equipment items when the game instance starts
+	//
+	UPROPERTY(Config, EditAnywhere, Category = "Asset Registry")
+	bool bScanOnStartup{ true };
+
+	//
+	// Whether to scan equipment items added by newly loaded maps
+	//
+	UPROPERTY(Config, EditAnywhere, Category = "Asset Registry")
+	bool bScanOnMapLoad{ true };
+
+	//
+	// Estimated memory of equipment assets kept loaded by the registry
+	// 
+	// Tips:
+	//	When exceeded, assets not used by any active equipment are evicted in least recently used order.
+	//	Unlimited if 0.
+	//	Can be tuned for each platform in the platform config.
+	//
+	UPROPERTY(Config, EditAnywhere, Category = "Asset Registry", meta = (ClampMin = 0, Units = "Megabytes"))
+	int32 AssetCacheBudgetMB{ 256 };
+
+	//
+	// Catalog of equipment items baked at cook time and loaded at startup
+	// 
+	// Tips:
+	//	Items not in the catalog are resolved from their equipment info.
+	//	Only used in cooked builds so that edits to equipment infos take effect in the editor.
+	//
+	UPROPERTY(Config, EditAnywhere, Category = "Asset Registry")
+	TSoftObjectPtr<UEquipmentCatalog> EquipmentCatalog;
+
+	///////////////////////////////////////////////
+	// Loading
+public:
+	//
+	// Whether adding equipment loads the Equipment class synchronously as a last resort if it is not loaded yet
+	// 
+	// Tips:
+	//	Enabled by default for projects that do not preload equipment with the asset registry.
+	//	Disable to guarantee that adding equipment never blocks the game thread.
+	//
+	UPROPERTY(Config, EditAnywhere, Category = "Loading")
+	bool bAllowSyncEquipmentClassLoad{ true };
+
+};
@@ -6,6 +6,10 @@
 #include "Equipment/Equipment.h"
 #include "Item/ItemInfo_Equipment.h"
 #include "Type/EquipmentMessageTypes.h"
+#include "Type/EquipmentChangeSetTypes.h"
+#include "EquipmentCatalog.h"
+#include "EquipmentSlotLayout.h"
+#include "Subsystem/EquipmentAssetRegistrySubsystem.h"
 #include "GameplayTag/GEEquipTags_Message.h"
 #include "GEEquipLogs.h"
 
@@ -65,6 +69,70 @@ bool FActiveEquipment::TryUnequip()
 }
 
 
+bool FActiveEquipment::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	// Handle
+
+	uint32 PackedHandle{ (Handle.GetGeneration() << FActiveEquipmentHandle::IndexBits) | Handle.GetIndex() };
+	Ar.SerializeIntPacked(PackedHandle);
+
+	if (Ar.IsLoading())
+	{
+		Handle = FActiveEquipmentHandle(PackedHandle & FActiveEquipmentHandle::IndexMask, PackedHandle >> FActiveEquipmentHandle::IndexBits);
+	}
+
+	// Slot index if stored in slot layout, otherwise slot tag
+	// Slot tag of the entry stored in slot layout is resolved by the container after receiving
+
+	uint8 bHasSlotIndex{ SlotIndex != INDEX_NONE };
+	Ar.SerializeBits(&bHasSlotIndex, 1);
+
+	if (bHasSlotIndex)
+	{
+		uint8 PackedSlotIndex{ static_cast<uint8>(SlotIndex) };
+		Ar << PackedSlotIndex;
+
+		SlotIndex = PackedSlotIndex;
+	}
+	else
+	{
+		SlotIndex = INDEX_NONE;
+
+		auto bSlotSuccess{ true };
+		Slot.NetSerialize(Ar, Map, bSlotSuccess);
+
+		bOutSuccess &= bSlotSuccess;
+	}
+
+	// Objects
+
+	UObject* ItemDataObject{ const_cast<UItemData*>(ItemData.Get()) };
+	Ar << ItemDataObject;
+
+	UObject* InstanceObject{ Instance.Get() };
+	Ar << InstanceObject;
+
+	if (Ar.IsLoading())
+	{
+		ItemData = Cast<UItemData>(ItemDataObject);
+		Instance = Cast<UEquipment>(InstanceObject);
+	}
+
+	// Flags
+
+	uint8 bEquipedBit{ bEquiped };
+	Ar.SerializeBits(&bEquipedBit, 1);
+
+	bEquiped = bEquipedBit;
+
+	bOutSuccess &= !Ar.IsError();
+
+	return bOutSuccess;
+}
+
+
 FString FActiveEquipment::GetDebugString() const
 {
 	return FString::Printf(TEXT("[%s](Slot: %s, Data: %s, Instance: %s) ")
@@ -87,13 +155,43 @@ bool FActiveEquipment::IsValid() const
 
 #pragma region FActiveEquipmentContainer
 
-void FActiveEquipmentContainer::RegisterOwner(AActor* InOwner, UEquipmentManagerComponent* InOwnerComponent)
+void FActiveEquipmentContainer::RegisterOwner(AActor* InOwner, UEquipmentManagerComponent* InOwnerComponent, const UEquipmentSlotLayout* InSlotLayout)
 {
 	check(InOwner);
 	check(InOwnerComponent);
 
 	Owner = InOwner;
 	OwnerComponent = InOwnerComponent;
+	SlotLayout = InSlotLayout;
+
+	// Allocate the storage for all slots of the layout in advance so that adding does not allocate
+
+	if (SlotLayout)
+	{
+		const auto NumSlots{ FMath::Min(SlotLayout->GetNumSlots(), UEquipmentSlotLayout::MaxSlots) };
+
+		Entries.Reserve(NumSlots);
+		LayoutSlotToEntry.Init(INDEX_NONE, NumSlots);
+		HandleIndexToEntry.Init(INDEX_NONE, FActiveEquipmentHandle::MaxIndex);
+	}
+	else
+	{
+		LayoutSlotToEntry.Reset();
+	}
+
+	ActiveHandles.Init(FActiveEquipmentHandle(), SlotLayout ? SlotLayout->GetNumActiveGroups() : 1);
+
+	if (!HandleTable.IsValid())
+	{
+		HandleTable = MakeShared<FActiveEquipmentHandleTable, ESPMode::ThreadSafe>();
+	}
+
+	// Restore the indices of the existing entries when the component is registered again
+
+	if (!Entries.IsEmpty())
+	{
+		RebuildIndices();
+	}
 }
 
 
@@ -103,20 +201,32 @@ void FActiveEquipmentContainer::PreReplicatedRemove(const TArrayView<int32> Remo
 	{
 		auto& Entry{ Entries[Index] };
 
-		if (Entry.TryUnequip())
+		if (TryUnequipEntry(Entry))
 		{
 			HandleEquipmentUnequiped(Entry);
 		}
 
 		HandleEquipmentRemove(Entry);
+
+		if (HandleTable.IsValid())
+		{
+			HandleTable->Unassign(Entry.Handle);
+		}
 	}
+
+	// Entries will be reordered after this, so the indices must be rebuilt
+
+	bIndicesDirty = true;
 }
 
 void FActiveEquipmentContainer::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
 {
+	RebuildIndices();
+
 	for (const auto& Index : AddedIndices)
 	{
 		auto& Entry{ Entries[Index] };
+		Entry.bReplicatedEquiped = Entry.bEquiped;
 
 		HandleEquipmentGiven(Entry);
 		HandleEquipmentEquiped(Entry);
@@ -125,68 +235,917 @@ void FActiveEquipmentContainer::PostReplicatedAdd(const TArrayView<int32> AddedI
 
 void FActiveEquipmentContainer::PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize)
 {
+	if (bIndicesDirty)
+	{
+		RebuildIndices();
+	}
+
 	for (const auto& Index : ChangedIndices)
 	{
 		auto& Entry{ Entries[Index] };
 
-		HandleEquipmentEquiped(Entry);
+		// Skip if only other properties of the entry have changed, e.g. the instance was resolved late
+
+		if (Entry.bEquiped == Entry.bReplicatedEquiped)
+		{
+			continue;
+		}
+
+		Entry.bReplicatedEquiped = Entry.bEquiped;
+
+		auto& GroupActiveHandle{ ActiveHandles[GetActiveGroupIndex(Entry)] };
+
+		if (Entry.bEquiped)
+		{
+			GroupActiveHandle = Entry.Handle;
+
+			HandleEquipmentEquiped(Entry);
+		}
+		else
+		{
+			if (GroupActiveHandle == Entry.Handle)
+			{
+				GroupActiveHandle = FActiveEquipmentHandle();
+			}
+
+			HandleEquipmentUnequiped(Entry);
+		}
+	}
+}
+
+void FActiveEquipmentContainer::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (bIndicesDirty)
+	{
+		RebuildIndices();
+	}
+
+	// Notify once after all removed, added and changed entries of this update are applied
+
+	FlushActiveSlotChangeMessages();
+}
+
+
+void FActiveEquipmentContainer::RebuildIndices()
+{
+	SlotToIndex.Reset();
+	HandleIndexToEntry.Init(INDEX_NONE, FActiveEquipmentHandle::MaxIndex);
+
+	for (auto& GroupActiveHandle : ActiveHandles)
+	{
+		GroupActiveHandle = FActiveEquipmentHandle();
+	}
+
+	for (auto& Index : LayoutSlotToEntry)
+	{
+		Index = INDEX_NONE;
+	}
+
+	for (auto It{ Entries.CreateConstIterator() }; It; ++It)
+	{
+		AddEntryToIndices(It.GetIndex());
+
+		// Mirror replicated handles so that they can be validated from the handle table
+
+		if (HandleTable.IsValid())
+		{
+			HandleTable->Assign(It->Handle);
+		}
+	}
+
+	bIndicesDirty = false;
+}
+
+void FActiveEquipmentContainer::AddEntryToIndices(int32 Index)
+{
+	auto& Entry{ Entries[Index] };
+
+	// Resolve the slot tag of the entry replicated with the slot index
+
+	if (SlotLayout && (Entry.SlotIndex != INDEX_NONE) && !Entry.Slot.IsValid())
+	{
+		Entry.Slot = SlotLayout->GetSlotTag(Entry.SlotIndex);
+	}
+
+	SetSlotEntryIndex(Entry, Index);
+
+	bRuleMasksDirty = true;
+
+	if (Entry.Handle.IsValid())
+	{
+		if (HandleIndexToEntry.IsEmpty())
+		{
+			HandleIndexToEntry.Init(INDEX_NONE, FActiveEquipmentHandle::MaxIndex);
+		}
+
+		HandleIndexToEntry[Entry.Handle.GetIndex()] = Index;
+	}
+
+	if (Entry.bEquiped)
+	{
+		ActiveHandles[GetActiveGroupIndex(Entry)] = Entry.Handle;
+	}
+}
+
+void FActiveEquipmentContainer::RemoveEntryAt(int32 Index)
+{
+	const auto& Entry{ Entries[Index] };
+
+	UnindexEntry(Entry);
+
+	auto& GroupActiveHandle{ ActiveHandles[GetActiveGroupIndex(Entry)] };
+
+	if (GroupActiveHandle == Entry.Handle)
+	{
+		GroupActiveHandle = FActiveEquipmentHandle();
+	}
+
+	// Order of Entries does not matter for replication, so swap the last entry into the hole
+
+	const auto LastIndex{ Entries.Num() - 1 };
+
+	Entries.RemoveAtSwap(Index);
+
+	if (Index != LastIndex)
+	{
+		const auto& MovedEntry{ Entries[Index] };
+
+		SetSlotEntryIndex(MovedEntry, Index);
+		HandleIndexToEntry[MovedEntry.Handle.GetIndex()] = Index;
+	}
+}
+
+void FActiveEquipmentContainer::RemoveEntryDeferred(int32 Index)
+{
+	auto& Entry{ Entries[Index] };
+
+	if (TryUnequipEntry(Entry))
+	{
 		HandleEquipmentUnequiped(Entry);
 	}
+
+	HandleEquipmentRemove(Entry);
+
+	// Only unindex it here and leave the entry in place until CompactPendingRemoveEntries()
+
+	UnindexEntry(Entry);
+
+	Entry.bPendingRemove = true;
+}
+
+void FActiveEquipmentContainer::CompactPendingRemoveEntries()
+{
+	Entries.RemoveAllSwap([](const FActiveEquipment& Entry) { return Entry.bPendingRemove; });
+
+	RebuildIndices();
+}
+
+void FActiveEquipmentContainer::UnindexEntry(const FActiveEquipment& Entry)
+{
+	SetSlotEntryIndex(Entry, INDEX_NONE);
+
+	bRuleMasksDirty = true;
+
+	if (Entry.Handle.IsValid() && HandleIndexToEntry.IsValidIndex(Entry.Handle.GetIndex()))
+	{
+		HandleIndexToEntry[Entry.Handle.GetIndex()] = INDEX_NONE;
+	}
+
+	if (HandleTable.IsValid())
+	{
+		HandleTable->Release(Entry.Handle);
+	}
+}
+
+int32 FActiveEquipmentContainer::FindEntryIndex(const FActiveEquipmentHandle& InHandle) const
+{
+	// Resolve by index of handle and reject if generation does not match
+
+	if (!InHandle.IsValid() || !HandleIndexToEntry.IsValidIndex(InHandle.GetIndex()))
+	{
+		return INDEX_NONE;
+	}
+
+	const auto Index{ HandleIndexToEntry[InHandle.GetIndex()] };
+
+	return Entries.IsValidIndex(Index) && (Entries[Index].Handle == InHandle) ? Index : INDEX_NONE;
+}
+
+int32 FActiveEquipmentContainer::FindEntryIndex(const FGameplayTag& InSlotTag) const
+{
+	if (SlotLayout)
+	{
+		return FindEntryIndexBySlotIndex(SlotLayout->FindSlotIndex(InSlotTag));
+	}
+
+	const auto* Index{ SlotToIndex.Find(InSlotTag) };
+
+	return Index ? *Index : INDEX_NONE;
+}
+
+int32 FActiveEquipmentContainer::FindEntryIndexBySlotIndex(int32 InSlotIndex) const
+{
+	return LayoutSlotToEntry.IsValidIndex(InSlotIndex) ? LayoutSlotToEntry[InSlotIndex] : INDEX_NONE;
+}
+
+void FActiveEquipmentContainer::SetSlotEntryIndex(const FActiveEquipment& Entry, int32 Index)
+{
+	// Store in the fixed storage if the entry is in the slot layout
+
+	if (LayoutSlotToEntry.IsValidIndex(Entry.SlotIndex))
+	{
+		LayoutSlotToEntry[Entry.SlotIndex] = Index;
+	}
+	else if (Index != INDEX_NONE)
+	{
+		SlotToIndex.Add(Entry.Slot, Index);
+	}
+	else
+	{
+		SlotToIndex.Remove(Entry.Slot);
+	}
+}
+
+int32 FActiveEquipmentContainer::GetActiveGroupIndex(const FActiveEquipment& Entry) const
+{
+	return SlotLayout ? SlotLayout->GetActiveGroupIndex(Entry.SlotIndex) : 0;
+}
+
+int32 FActiveEquipmentContainer::GetActiveGroupIndex(const FGameplayTag& InSlotTag) const
+{
+	return SlotLayout ? SlotLayout->GetActiveGroupIndex(SlotLayout->FindSlotIndex(InSlotTag)) : 0;
+}
+
+bool FActiveEquipmentContainer::TryEquipEntry(FActiveEquipment& ActiveEquipment)
+{
+	if (ActiveEquipment.TryEquip())
+	{
+		ActiveHandles[GetActiveGroupIndex(ActiveEquipment)] = ActiveEquipment.Handle;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool FActiveEquipmentContainer::TryUnequipEntry(FActiveEquipment& ActiveEquipment)
+{
+	if (ActiveEquipment.TryUnequip())
+	{
+		auto& GroupActiveHandle{ ActiveHandles[GetActiveGroupIndex(ActiveEquipment)] };
+
+		if (GroupActiveHandle == ActiveEquipment.Handle)
+		{
+			GroupActiveHandle = FActiveEquipmentHandle();
+		}
+
+		return true;
+	}
+
+	return false;
 }
 
 
-bool FActiveEquipmentContainer::AddEquipmentItem(const FGameplayTag& InSlotTag, const UItemData* InItemData, FActiveEquipmentHandle& OutHandle, bool bEquipImmediately)
+bool FActiveEquipmentContainer::AddEquipmentItem(const FGameplayTag& InSlotTag, const UItemData* InItemData, FActiveEquipmentHandle& OutHandle, bool bEquipImmediately, FName ResolveContext, TSubclassOf<UEquipment> InEquipmentClass)
 {
 	check(Owner);
 	check(OwnerComponent);
 
-	// Suspend if arguments are invalid
+	// Suspend if Equipment class cannot be resolved
 
-	if (!InItemData || !InSlotTag.IsValid())
+	const auto EquipmentClass{ ResolveEquipmentClass(InSlotTag, InItemData, ResolveContext, InEquipmentClass) };
+
+	if (!EquipmentClass)
 	{
 		return false;
 	}
 
-	// Suspend if No Equipment Info in ItemData
+	// Suspend if the required slots are not occupied
+
+	TArray<int32> ConflictIndices;
+
+	if (!GatherAddConflicts(InSlotTag, InItemData, ConflictIndices))
+	{
+		return false;
+	}
+
+	// Apply as one batched update if an entry is replaced or removed so that the old entry
+	// and the new entry are swapped before entries requiring the slot are tested
+
+	const auto bReplace{ FindEntryIndex(InSlotTag) != INDEX_NONE };
+
+	if (!ConflictIndices.IsEmpty() || bReplace || HasRequiredSlots())
+	{
+		FEquipmentChangeSet ChangeSet;
+		ChangeSet.AddEquipmentItem(InSlotTag, InItemData, bEquipImmediately, ResolveContext, EquipmentClass);
+
+		TArray<FActiveEquipmentHandle> AddedHandles;
+		ApplyChangeSet(ChangeSet, AddedHandles);
+
+		OutHandle = AddedHandles.IsEmpty() ? FActiveEquipmentHandle() : AddedHandles[0];
+
+		return OutHandle.IsValid();
+	}
+
+	// Notify the active change only once after adding and equipping
+
+	auto NewIndex{ INDEX_NONE };
+	{
+		TGuardValue<bool> DeferGuard(bDeferActiveSlotMessages, true);
+
+		// Add new entry to the empty slot
+
+		NewIndex = AddEntry(InSlotTag, InItemData, EquipmentClass);
+
+		// Equip it if it is to be equipped immediately
+
+		if ((NewIndex != INDEX_NONE) && bEquipImmediately)
+		{
+			EquipEquipment(Entries[NewIndex].Handle);
+		}
+	}
+
+	FlushActiveSlotChangeMessages();
+
+	if (NewIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutHandle = Entries[NewIndex].Handle;
+	
+	MarkItemDirty(Entries[NewIndex]);
+
+	return true;
+}
+
+void FActiveEquipmentContainer::ApplyChangeSet(const FEquipmentChangeSet& ChangeSet, TArray<FActiveEquipmentHandle>& OutAddedHandles)
+{
+	check(Owner);
+	check(OwnerComponent);
+
+	// Suspend if there is no change
+
+	if (ChangeSet.IsEmpty())
+	{
+		return;
+	}
+
+	// Defer slot change messages until all changes are applied
+
+	bApplyingChangeSet = true;
+
+	TSet<FActiveEquipmentHandle> DirtyHandles;
+	auto DesiredActiveHandles{ ActiveHandles };
+	auto bRemoved{ false };
+
+	const auto FindChangeTargetIndex
+	{
+		[this](const FEquipmentChange& Change)
+		{
+			return Change.Handle.IsValid() ? FindEntryIndex(Change.Handle) : FindEntryIndex(Change.SlotTag);
+		}
+	};
+
+	const auto RemoveChangeTarget
+	{
+		[this, &DesiredActiveHandles, &bRemoved](int32 Index)
+		{
+			auto& DesiredActiveHandle{ DesiredActiveHandles[GetActiveGroupIndex(Entries[Index])] };
+
+			if (Entries[Index].Handle == DesiredActiveHandle)
+			{
+				DesiredActiveHandle = FActiveEquipmentHandle();
+			}
+
+			RemoveEntryDeferred(Index);
+
+			bRemoved = true;
+		}
+	};
+
+	// Apply add and remove in order and only record the equipped entry of each group
+
+	for (const auto& Change : ChangeSet.GetChanges())
+	{
+		switch (Change.Type)
+		{
+		case EEquipmentChangeType::Add:
+		{
+			if (const auto EquipmentClass{ ResolveEquipmentClass(Change.SlotTag, Change.ItemData, Change.ResolveContext, Change.EquipmentClass) })
+			{
+				TArray<int32> ConflictIndices;
+
+				if (!GatherAddConflicts(Change.SlotTag, Change.ItemData, ConflictIndices))
+				{
+					break;
+				}
+
+				for (const auto& ConflictIndex : ConflictIndices)
+				{
+					RemoveChangeTarget(ConflictIndex);
+				}
+
+				const auto OldIndex{ FindEntryIndex(Change.SlotTag) };
+
+				if (OldIndex != INDEX_NONE)
+				{
+					RemoveChangeTarget(OldIndex);
+				}
+
+				const auto NewIndex{ AddEntry(Change.SlotTag, Change.ItemData, EquipmentClass) };
+
+				if (NewIndex == INDEX_NONE)
+				{
+					break;
+				}
+
+				const auto& NewHandle{ Entries[NewIndex].Handle };
+
+				DirtyHandles.Add(NewHandle);
+				OutAddedHandles.Add(NewHandle);
+
+				if (Change.bEquipImmediately)
+				{
+					DesiredActiveHandles[GetActiveGroupIndex(Entries[NewIndex])] = NewHandle;
+				}
+			}
+			break;
+		}
+
+		case EEquipmentChangeType::Remove:
+		{
+			const auto Index{ FindChangeTargetIndex(Change) };
+
+			if (Index != INDEX_NONE)
+			{
+				RemoveChangeTarget(Index);
+			}
+			break;
+		}
+
+		case EEquipmentChangeType::RemoveAll:
+		{
+			for (auto It{ Entries.CreateConstIterator() }; It; ++It)
+			{
+				if (!It->bPendingRemove)
+				{
+					RemoveChangeTarget(It.GetIndex());
+				}
+			}
+			break;
+		}
+
+		case EEquipmentChangeType::Equip:
+		{
+			if (!Change.Handle.IsValid() && !Change.SlotTag.IsValid())
+			{
+				break;
+			}
+
+			const auto Index{ FindChangeTargetIndex(Change) };
+
+			if (Index != INDEX_NONE)
+			{
+				DesiredActiveHandles[GetActiveGroupIndex(Entries[Index])] = Entries[Index].Handle;
+			}
+			else
+			{
+				DesiredActiveHandles[GetActiveGroupIndex(Change.SlotTag)] = FActiveEquipmentHandle();
+			}
+			break;
+		}
+
+		case EEquipmentChangeType::Unequip:
+		{
+			const auto Index{ FindChangeTargetIndex(Change) };
+
+			if (Index != INDEX_NONE)
+			{
+				auto& DesiredActiveHandle{ DesiredActiveHandles[GetActiveGroupIndex(Entries[Index])] };
+
+				if (Entries[Index].Handle == DesiredActiveHandle)
+				{
+					DesiredActiveHandle = FActiveEquipmentHandle();
+				}
+			}
+			break;
+		}
+		}
+	}
+
+	// Remove entries whose required slots are no longer occupied until nothing more is removed
+
+	if (bRemoved)
+	{
+		for (auto Index{ FindUnsatisfiedEntryIndex() }; Index != INDEX_NONE; Index = FindUnsatisfiedEntryIndex())
+		{
+			RemoveChangeTarget(Index);
+		}
+	}
+
+	// Switch to the final equipped entry only in the changed groups
+
+	for (auto GroupIndex{ 0 }; GroupIndex < ActiveHandles.Num(); ++GroupIndex)
+	{
+		if (DesiredActiveHandles[GroupIndex] == ActiveHandles[GroupIndex])
+		{
+			continue;
+		}
+
+		const auto OldEquipedIndex{ FindEntryIndex(ActiveHandles[GroupIndex]) };
+
+		if (OldEquipedIndex != INDEX_NONE)
+		{
+			auto& Entry{ Entries[OldEquipedIndex] };
+
+			if (TryUnequipEntry(Entry))
+			{
+				HandleEquipmentUnequiped(Entry);
+
+				DirtyHandles.Add(Entry.Handle);
+			}
+		}
+
+		const auto NewEquipedIndex{ FindEntryIndex(DesiredActiveHandles[GroupIndex]) };
+
+		if (NewEquipedIndex != INDEX_NONE)
+		{
+			auto& Entry{ Entries[NewEquipedIndex] };
+
+			if (TryEquipEntry(Entry))
+			{
+				TArray<FActiveEquipmentHandle> UnequipedHandles;
+				UnequipConflictingEntries(NewEquipedIndex, UnequipedHandles);
+
+				DirtyHandles.Append(UnequipedHandles);
+
+				HandleEquipmentEquiped(Entry);
+
+				DirtyHandles.Add(Entry.Handle);
+			}
+		}
+	}
+
+	// Compact removed entries at once and mark the array dirty
+
+	if (bRemoved)
+	{
+		CompactPendingRemoveEntries();
+	}
+
+	for (const auto& Handle : DirtyHandles)
+	{
+		const auto Index{ FindEntryIndex(Handle) };
+
+		if (Index != INDEX_NONE)
+		{
+			MarkItemDirty(Entries[Index]);
+		}
+	}
+
+	if (bRemoved && DirtyHandles.IsEmpty())
+	{
+		MarkArrayDirty();
+	}
+
+	// Send one message for each changed slot
+
+	bApplyingChangeSet = false;
+
+	if (!bDeferSlotMessagesToEndOfFrame)
+	{
+		FlushSlotChangeMessages();
+	}
+
+	FlushActiveSlotChangeMessages();
+}
+
+
+const FEquipmentSlotRules* FActiveEquipmentContainer::FindItemSlotRules(const UItemData* InItemData) const
+{
+	if (!InItemData)
+	{
+		return nullptr;
+	}
+
+	// Use the rules baked in the catalog if exists
+
+	const auto* Registry{ UEquipmentAssetRegistrySubsystem::Get(Owner) };
+
+	if (const auto* CatalogEntry{ Registry ? Registry->FindCatalogEntry(InItemData) : nullptr })
+	{
+		return &CatalogEntry->SlotRules;
+	}
+
+	const auto* EquipmentInfo{ InItemData->FindInfo<UItemInfo_Equipment>() };
+
+	return EquipmentInfo ? &EquipmentInfo->GetSlotRules() : nullptr;
+}
+
+const FEquipmentSlotRules* FActiveEquipmentContainer::FindLayoutSlotRules(int32 InSlotIndex) const
+{
+	return (SlotLayout && SlotLayout->GetSlots().IsValidIndex(InSlotIndex)) ? &SlotLayout->GetSlots()[InSlotIndex].Rules : nullptr;
+}
+
+void FActiveEquipmentContainer::BuildRuleMasks(FActiveEquipment& Entry) const
+{
+	Entry.RuleMasks.Build(Entry.Slot, FindItemSlotRules(Entry.ItemData), FindLayoutSlotRules(Entry.SlotIndex));
+}
+
+void FActiveEquipmentContainer::UpdateRuleMasks()
+{
+	// Rebuild the masks of all entries if the slot indices were reassigned
+
+	const auto Serial{ FEquipmentSlotIndexRegistry::Get().GetSerial() };
+
+	if (RuleMasksSerial != Serial)
+	{
+		for (auto& Entry : Entries)
+		{
+			BuildRuleMasks(Entry);
+		}
+
+		RuleMasksSerial = Serial;
+		bRuleMasksDirty = true;
+	}
+
+	// Combine the masks of all entries
+
+	if (bRuleMasksDirty)
+	{
+		CombinedRuleMasks = FEquipmentSlotRuleMasks();
+
+		for (const auto& Entry : Entries)
+		{
+			if (!Entry.bPendingRemove)
+			{
+				CombinedRuleMasks.SlotMask.Append(Entry.RuleMasks.SlotMask);
+				CombinedRuleMasks.RemoveMask.Append(Entry.RuleMasks.RemoveMask);
+				CombinedRuleMasks.UnequipMask.Append(Entry.RuleMasks.UnequipMask);
+				CombinedRuleMasks.RequiredMask.Append(Entry.RuleMasks.RequiredMask);
+			}
+		}
+
+		bRuleMasksDirty = false;
+	}
+}
+
+bool FActiveEquipmentContainer::GatherAddConflicts(const FGameplayTag& InSlotTag, const UItemData* InItemData, TArray<int32>& OutRemoveIndices)
+{
+	UpdateRuleMasks();
+
+	FEquipmentSlotRuleMasks NewMasks;
+	NewMasks.Build(InSlotTag, FindItemSlotRules(InItemData), FindLayoutSlotRules(SlotLayout ? SlotLayout->FindSlotIndex(InSlotTag) : INDEX_NONE));
+
+	const auto ReplacedIndex{ FindEntryIndex(InSlotTag) };
+
+	// Only look for the conflicting entries if the combined masks of all entries conflict
+
+	if (NewMasks.RemovesOnAdd(CombinedRuleMasks))
+	{
+		for (auto It{ Entries.CreateConstIterator() }; It; ++It)
+		{
+			if (!It->bPendingRemove && (It.GetIndex() != ReplacedIndex) && NewMasks.RemovesOnAdd(It->RuleMasks))
+			{
+				OutRemoveIndices.Add(It.GetIndex());
+			}
+		}
+	}
+
+	// Test the required slots with the entries remaining after the add
+
+	if (NewMasks.RequiredMask.IsEmpty())
+	{
+		return true;
+	}
+
+	auto bSatisfied{ false };
+
+	if (OutRemoveIndices.IsEmpty() && (ReplacedIndex == INDEX_NONE))
+	{
+		bSatisfied = CombinedRuleMasks.SlotMask.Contains(NewMasks.RequiredMask);
+	}
+	else
+	{
+		FEquipmentSlotMask OccupiedMask;
+
+		for (auto It{ Entries.CreateConstIterator() }; It; ++It)
+		{
+			if (!It->bPendingRemove && (It.GetIndex() != ReplacedIndex) && !OutRemoveIndices.Contains(It.GetIndex()))
+			{
+				OccupiedMask.Append(It->RuleMasks.SlotMask);
+			}
+		}
+
+		bSatisfied = OccupiedMask.Contains(NewMasks.RequiredMask);
+	}
+
+	UE_CLOG(!bSatisfied, LogGameCore_Equipment, Warning, TEXT("Cannot add [%s] to Slot(%s) because its required slots are not occupied"), *GetNameSafe(InItemData), *InSlotTag.ToString());
+
+	return bSatisfied;
+}
+
+void FActiveEquipmentContainer::UnequipConflictingEntries(int32 Index, TArray<FActiveEquipmentHandle>& OutUnequipedHandles)
+{
+	if (!Entries.IsValidIndex(Index))
+	{
+		return;
+	}
+
+	UpdateRuleMasks();
+
+	const auto& Masks{ Entries[Index].RuleMasks };
+
+	// Only look for the conflicting entries if the combined masks of all entries conflict
+
+	if (!Masks.UnequipsOnEquip(CombinedRuleMasks))
+	{
+		return;
+	}
+
+	for (auto It{ Entries.CreateIterator() }; It; ++It)
+	{
+		if ((It.GetIndex() != Index) && !It->bPendingRemove && Masks.UnequipsOnEquip(It->RuleMasks) && TryUnequipEntry(*It))
+		{
+			HandleEquipmentUnequiped(*It);
+
+			OutUnequipedHandles.Add(It->Handle);
+		}
+	}
+}
+
+int32 FActiveEquipmentContainer::FindUnsatisfiedEntryIndex()
+{
+	UpdateRuleMasks();
+
+	if (CombinedRuleMasks.RequiredMask.IsEmpty() || CombinedRuleMasks.SlotMask.Contains(CombinedRuleMasks.RequiredMask))
+	{
+		return INDEX_NONE;
+	}
+
+	for (auto It{ Entries.CreateConstIterator() }; It; ++It)
+	{
+		if (!It->bPendingRemove && !CombinedRuleMasks.SlotMask.Contains(It->RuleMasks.RequiredMask))
+		{
+			return It.GetIndex();
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+bool FActiveEquipmentContainer::HasRequiredSlots()
+{
+	UpdateRuleMasks();
+
+	return !CombinedRuleMasks.RequiredMask.IsEmpty();
+}
+
+
+const UItemInfo_Equipment* FActiveEquipmentContainer::FindEquipmentInfo(const FGameplayTag& InSlotTag, const UItemData* InItemData) const
+{
+	// Suspend if arguments are invalid
+
+	if (!InItemData || !InSlotTag.IsValid())
+	{
+		return nullptr;
+	}
+
+	// Suspend if No Equipment Info in ItemData
+
+	const auto* EquipmentInfo{ InItemData->FindInfo<UItemInfo_Equipment>() };
+
+	if (!EquipmentInfo)
+	{
+		return nullptr;
+	}
+
+	// Suspend if the slot cannot be added
+
+	if (!EquipmentInfo->CanAddToSlot(InSlotTag))
+	{
+		return nullptr;
+	}
+
+	return EquipmentInfo;
+}
+
+TSubclassOf<UEquipment> FActiveEquipmentContainer::ResolveEquipmentClass(const FGameplayTag& InSlotTag, const UItemData* InItemData, FName ResolveContext, TSubclassOf<UEquipment> InEquipmentClass) const
+{
+	// Use the class resolved by the caller as long as the item can be added to the slot
+
+	if (InEquipmentClass)
+	{
+		return FindEquipmentInfo(InSlotTag, InItemData) ? InEquipmentClass : nullptr;
+	}
+
+	// Use the entry baked in the catalog if exists.
+	// Baked entries only hold the default class, so items resolved for a context always go through the resolver.
+
+	const auto* Registry{ InItemData ? UEquipmentAssetRegistrySubsystem::Get(Owner) : nullptr };
+	const auto* CatalogEntry{ (Registry && ResolveContext.IsNone()) ? Registry->FindCatalogEntry(InItemData) : nullptr };
+
+	if (CatalogEntry)
+	{
+		if (!InSlotTag.IsValid() || !CatalogEntry->CanAddToSlot(InSlotTag))
+		{
+			return nullptr;
+		}
+
+		UE_CLOG(CatalogEntry->EquipmentClass.IsNull(), LogGameCore_Equipment, Error, TEXT("EquipmentClass has not set in [%s]"), *GetNameSafe(InItemData));
+
+		return CatalogEntry->GetEquipmentClass();
+	}
+
+	// Suspend if the item cannot be added to the slot
+
+	const auto* EquipmentInfo{ FindEquipmentInfo(InSlotTag, InItemData) };
+
+	if (!EquipmentInfo)
+	{
+		return nullptr;
+	}
+
+	// Use the cached resolution for the context, or resolve it directly if the registry is not available.
+	// Resolve only once so that an unloaded class is reported and loaded at most once.
+
+	TSubclassOf<UEquipment> EquipmentClass{ nullptr };
+
+	if (Registry)
+	{
+		const UItemInfo_Equipment* ResolvedInfo{ nullptr };
+		Registry->ResolveEquipment(InItemData, ResolveContext, ResolvedInfo, EquipmentClass);
+	}
+	else
+	{
+		EquipmentClass = EquipmentInfo->GetEquipmentClassForContext(ResolveContext);
+	}
+
+	// Suspend if Equipment class is invalid or not loaded
+
+	if (!EquipmentClass)
+	{
+		UE_CLOG(EquipmentInfo->GetSoftEquipmentClassForContext(ResolveContext).IsNull(), LogGameCore_Equipment, Error, TEXT("EquipmentClass has not set in [%s]"), *GetNameSafe(InItemData));
+		return nullptr;
+	}
+
+	return EquipmentClass;
+}
+
+TSoftClassPtr<UEquipment> FActiveEquipmentContainer::ResolveSoftEquipmentClass(const FGameplayTag& InSlotTag, const UItemData* InItemData, FName ResolveContext) const
+{
+	// Follow the same order as ResolveEquipmentClass() so that the streamed class is the one to be added
 
-	const auto* EquipmentInfo{ InItemData->FindInfo<UItemInfo_Equipment>() };
+	const auto* Registry{ (InItemData && ResolveContext.IsNone()) ? UEquipmentAssetRegistrySubsystem::Get(Owner) : nullptr };
 
-	if (!EquipmentInfo)
+	if (const auto* CatalogEntry{ Registry ? Registry->FindCatalogEntry(InItemData) : nullptr })
 	{
-		return false;
+		return (InSlotTag.IsValid() && CatalogEntry->CanAddToSlot(InSlotTag)) ? CatalogEntry->EquipmentClass : TSoftClassPtr<UEquipment>();
 	}
 
-	// Suspend if the slot cannot be added
+	const auto* EquipmentInfo{ FindEquipmentInfo(InSlotTag, InItemData) };
 
-	const auto& AddableSlots{ EquipmentInfo->GetAddableSlots() };
+	return EquipmentInfo ? EquipmentInfo->GetSoftEquipmentClassForContext(ResolveContext) : TSoftClassPtr<UEquipment>();
+}
 
-	if (AddableSlots.IsValid() && !AddableSlots.HasTag(InSlotTag))
-	{
-		return false;
-	}
+int32 FActiveEquipmentContainer::AddEntry(const FGameplayTag& InSlotTag, const UItemData* InItemData, TSubclassOf<UEquipment> EquipmentClass)
+{
+	check(HandleTable);
 
-	// Suspend if Equipment class is invalid
+	// Suspend if the slot is not defined in the slot layout
 
-	const auto& EquipmentClass{ EquipmentInfo->GetEquipmentClass() };
+	const auto SlotIndex{ SlotLayout ? SlotLayout->FindSlotIndex(InSlotTag) : INDEX_NONE };
 
-	if (!EquipmentClass)
+	if (SlotLayout && (SlotIndex == INDEX_NONE))
 	{
-		UE_LOG(LogGameCore_Equipment, Error, TEXT("EquipmentClass has not set in [%s]"), *GetNameSafe(InItemData));
-		return false;
+		UE_LOG(LogGameCore_Equipment, Error, TEXT("Slot(%s) is not defined in slot layout [%s] of [%s]"), *InSlotTag.ToString(), *GetNameSafe(SlotLayout), *GetNameSafe(OwnerComponent));
+		return INDEX_NONE;
 	}
 
-	// Remove if already in slot
+	// Suspend if no more handle can be allocated
+
+	const auto NewHandle{ HandleTable->Allocate() };
 
-	RemoveEquipmentItem(InSlotTag);
+	if (!NewHandle.IsValid())
+	{
+		UE_LOG(LogGameCore_Equipment, Error, TEXT("Too many equipment items added to [%s] (Max: %u)"), *GetNameSafe(OwnerComponent), FActiveEquipmentHandle::MaxIndex);
+		return INDEX_NONE;
+	}
 
 	// Add new entry
 
-	auto& NewEntry{ Entries.AddDefaulted_GetRef() };
-	NewEntry.Handle.GenerateNewHandle();
+	const auto NewIndex{ Entries.AddDefaulted() };
+
+	auto& NewEntry{ Entries[NewIndex] };
+	NewEntry.Handle = NewHandle;
 	NewEntry.Slot = InSlotTag;
+	NewEntry.SlotIndex = SlotIndex;
 	NewEntry.ItemData = InItemData;
 
-	OutHandle = NewEntry.Handle;
+	BuildRuleMasks(NewEntry);
+
+	AddEntryToIndices(NewIndex);
 
 	// Create Instance
 
@@ -196,19 +1155,7 @@ bool FActiveEquipmentContainer::AddEquipmentItem(const FGameplayTag& InSlotTag,
 
 	HandleEquipmentGiven(NewEntry);
 
-	// Equip it if it is to be equipped immediately
-
-	if (bEquipImmediately)
-	{
-		if (NewEntry.TryEquip())
-		{
-			HandleEquipmentEquiped(NewEntry);
-		}
-	}
-	
-	MarkItemDirty(NewEntry);
-
-	return true;
+	return NewIndex;
 }
 
 
@@ -221,27 +1168,39 @@ void FActiveEquipmentContainer::RemoveEquipmentItem(const FActiveEquipmentHandle
 		return;
 	}
 
-	// Remove by handles
+	// Apply as one batched update if other entries may require the slot
 
-	for (auto It{ Entries.CreateIterator() }; It; ++It)
+	if (HasRequiredSlots())
 	{
-		auto& Entry{ *It };
+		FEquipmentChangeSet ChangeSet;
+		ChangeSet.RemoveEquipmentItem(InHandle);
 
-		if (Entry.Handle == InHandle)
-		{
-			if (Entry.TryUnequip())
-			{
-				HandleEquipmentUnequiped(Entry);
-			}
+		TArray<FActiveEquipmentHandle> AddedHandles;
+		ApplyChangeSet(ChangeSet, AddedHandles);
+		return;
+	}
 
-			HandleEquipmentRemove(Entry);
+	// Remove by handle
 
-			It.RemoveCurrent();
-			break;
+	const auto Index{ FindEntryIndex(InHandle) };
+
+	if (Index != INDEX_NONE)
+	{
+		auto& Entry{ Entries[Index] };
+
+		if (TryUnequipEntry(Entry))
+		{
+			HandleEquipmentUnequiped(Entry);
 		}
-	}
 
-	MarkArrayDirty();
+		HandleEquipmentRemove(Entry);
+
+		RemoveEntryAt(Index);
+
+		MarkArrayDirty();
+
+		FlushActiveSlotChangeMessages();
+	}
 }
 
 void FActiveEquipmentContainer::RemoveEquipmentItem(const FGameplayTag& InSlotTag)
@@ -253,27 +1212,39 @@ void FActiveEquipmentContainer::RemoveEquipmentItem(const FGameplayTag& InSlotTa
 		return;
 	}
 
+	// Apply as one batched update if other entries may require the slot
+
+	if (HasRequiredSlots())
+	{
+		FEquipmentChangeSet ChangeSet;
+		ChangeSet.RemoveEquipmentItem(InSlotTag);
+
+		TArray<FActiveEquipmentHandle> AddedHandles;
+		ApplyChangeSet(ChangeSet, AddedHandles);
+		return;
+	}
+
 	// Remove by tag
 
-	for (auto It{ Entries.CreateIterator() }; It; ++It)
+	const auto Index{ FindEntryIndex(InSlotTag) };
+
+	if (Index != INDEX_NONE)
 	{
-		auto& Entry{ *It };
+		auto& Entry{ Entries[Index] };
 
-		if (Entry.Slot == InSlotTag)
+		if (TryUnequipEntry(Entry))
 		{
-			if (Entry.TryUnequip())
-			{
-				HandleEquipmentUnequiped(Entry);
-			}
+			HandleEquipmentUnequiped(Entry);
+		}
 
-			HandleEquipmentRemove(Entry);
+		HandleEquipmentRemove(Entry);
 
-			It.RemoveCurrent();
-			break;
-		}
-	}
+		RemoveEntryAt(Index);
 
-	MarkArrayDirty();
+		MarkArrayDirty();
+
+		FlushActiveSlotChangeMessages();
+	}
 }
 
 void FActiveEquipmentContainer::RemoveMultipleEquipmentItems(const TSet<FActiveEquipmentHandle>& Handles)
@@ -287,160 +1258,189 @@ void FActiveEquipmentContainer::RemoveMultipleEquipmentItems(const TSet<FActiveE
 
 	// Remove by handles
 
-	for (auto It{ Entries.CreateIterator() }; It; ++It)
+	auto bRemoved{ false };
+
+	for (const auto& Handle : Handles)
 	{
-		auto& Entry{ *It };
+		const auto Index{ FindEntryIndex(Handle) };
 
-		if (Handles.Contains(Entry.Handle))
+		if (Index != INDEX_NONE)
 		{
-			if (Entry.TryUnequip())
-			{
-				HandleEquipmentUnequiped(Entry);
-			}
+			RemoveEntryDeferred(Index);
 
-			HandleEquipmentRemove(Entry);
-
-			It.RemoveCurrent();
+			bRemoved = true;
 		}
 	}
 
-	MarkArrayDirty();
+	// Remove entries whose required slots are no longer occupied and compact removed entries at once
+
+	if (bRemoved)
+	{
+		for (auto Index{ FindUnsatisfiedEntryIndex() }; Index != INDEX_NONE; Index = FindUnsatisfiedEntryIndex())
+		{
+			RemoveEntryDeferred(Index);
+		}
+
+		CompactPendingRemoveEntries();
+
+		MarkArrayDirty();
+
+		FlushActiveSlotChangeMessages();
+	}
 }
 
 void FActiveEquipmentContainer::RemoveAllEquipmentItem()
 {
-	for (auto It{ Entries.CreateIterator() }; It; ++It)
+	for (auto& Entry : Entries)
 	{
-		auto& Entry{ *It };
-
-		if (Entry.TryUnequip())
+		if (TryUnequipEntry(Entry))
 		{
 			HandleEquipmentUnequiped(Entry);
 		}
 
 		HandleEquipmentRemove(Entry);
 
-		It.RemoveCurrent();
+		UnindexEntry(Entry);
+	}
+
+	Entries.Reset();
+
+	for (auto& GroupActiveHandle : ActiveHandles)
+	{
+		GroupActiveHandle = FActiveEquipmentHandle();
 	}
 
 	MarkArrayDirty();
+
+	FlushActiveSlotChangeMessages();
+}
+
+void FActiveEquipmentContainer::ReleaseAll()
+{
+	// Items still waiting for initialization have not acquired anything
+
+	PendingGivenHandles.Empty();
+	PendingEquipedHandles.Empty();
+
+	auto* Registry{ Owner ? UEquipmentAssetRegistrySubsystem::Get(Owner) : nullptr };
+
+	for (auto& Entry : Entries)
+	{
+		if (Entry.bAcquiredAssets)
+		{
+			Entry.bAcquiredAssets = false;
+
+			if (Registry)
+			{
+				Registry->ReleaseEquipment(Entry.ItemData);
+			}
+		}
+	}
 }
 
 
 bool FActiveEquipmentContainer::EquipEquipment(const FActiveEquipmentHandle& Handle)
 {
-	auto bResult{ false };
-
 	// Suspend if Handle is invalid
 
 	if (!Handle.IsValid())
 	{
-		return bResult;
+		return false;
 	}
 
-	// Find equipment
+	// Suspend if equipment is not found
 
-	int32 OldEquipedIndex{ INDEX_NONE };
-	int32 NewEquipedIndex{ INDEX_NONE };
+	const auto NewEquipedIndex{ FindEntryIndex(Handle) };
 
-	for (auto It{ Entries.CreateConstIterator() }; It; ++It)
+	if (NewEquipedIndex == INDEX_NONE)
 	{
-		if (It->Handle == Handle)
-		{
-			NewEquipedIndex = It.GetIndex();
-		}
-
-		if (It->bEquiped)
-		{
-			OldEquipedIndex = It.GetIndex();
-		}
+		return false;
 	}
 
-	// Suspend if old and new index are same
+	// Suspend if already equipped in the group
 
-	if (OldEquipedIndex == NewEquipedIndex)
+	const auto& GroupActiveHandle{ ActiveHandles[GetActiveGroupIndex(Entries[NewEquipedIndex])] };
+
+	if (GroupActiveHandle == Handle)
 	{
 		return false;
 	}
 
-	// Unequip old equipment
+	// Notify the active change only once after switching
 
-	if (OldEquipedIndex != INDEX_NONE)
+	auto bEquiped{ false };
 	{
-		UnequipEquipment(Entries[OldEquipedIndex]);
-	}
+		TGuardValue<bool> DeferGuard(bDeferActiveSlotMessages, true);
 
-	// Equip new equipment
+		// Unequip old equipment only in the same group
 
-	if (NewEquipedIndex != INDEX_NONE)
-	{
-		bResult = EquipEquipment(Entries[NewEquipedIndex]);
+		const auto OldEquipedIndex{ FindEntryIndex(GroupActiveHandle) };
+
+		if (OldEquipedIndex != INDEX_NONE)
+		{
+			UnequipEquipment(Entries[OldEquipedIndex]);
+		}
+
+		// Equip new equipment
+
+		bEquiped = EquipEquipment(Entries[NewEquipedIndex]);
 	}
 
-	return bResult;
+	FlushActiveSlotChangeMessages();
+
+	return bEquiped;
 }
 
 bool FActiveEquipmentContainer::EquipEquipment(const FGameplayTag& SlotTag)
 {
-	auto bResult{ false };
-
 	// Suspend if tag is invalid
 
 	if (!SlotTag.IsValid())
 	{
-		return bResult;
+		return false;
 	}
 
 	// Find equipment
 
-	int32 OldEquipedIndex{ INDEX_NONE };
-	int32 NewEquipedIndex{ INDEX_NONE };
+	const auto NewEquipedIndex{ FindEntryIndex(SlotTag) };
 
-	for (auto It{ Entries.CreateConstIterator() }; It; ++It)
+	if (NewEquipedIndex != INDEX_NONE)
 	{
-		if (It->Slot == SlotTag)
-		{
-			NewEquipedIndex = It.GetIndex();
-		}
-
-		if (It->bEquiped)
-		{
-			OldEquipedIndex = It.GetIndex();
-		}
+		return EquipEquipment(Entries[NewEquipedIndex].Handle);
 	}
 
-	// Suspend if old and new index are same
-
-	if (OldEquipedIndex == NewEquipedIndex)
-	{
-		return false;
-	}
+	// Unequip old equipment in the group of the slot even if there is no equipment in the slot
 
-	// Unequip old equipment
+	const auto OldEquipedIndex{ FindEntryIndex(ActiveHandles[GetActiveGroupIndex(SlotTag)]) };
 
 	if (OldEquipedIndex != INDEX_NONE)
 	{
 		UnequipEquipment(Entries[OldEquipedIndex]);
 	}
 
-	// Equip new equipment
-
-	if (NewEquipedIndex != INDEX_NONE)
-	{
-		bResult = EquipEquipment(Entries[NewEquipedIndex]);
-	}
-
-	return bResult;
+	return false;
 }
 
 bool FActiveEquipmentContainer::EquipEquipment(FActiveEquipment& ActiveEquipment)
 {
-	if (ActiveEquipment.TryEquip())
+	if (TryEquipEntry(ActiveEquipment))
 	{
+		// Unequip entries that cannot be equipped together
+
+		TArray<FActiveEquipmentHandle> UnequipedHandles;
+		UnequipConflictingEntries(FindEntryIndex(ActiveEquipment.Handle), UnequipedHandles);
+
+		for (const auto& Handle : UnequipedHandles)
+		{
+			MarkItemDirty(Entries[FindEntryIndex(Handle)]);
+		}
+
 		HandleEquipmentEquiped(ActiveEquipment);
 
 		MarkItemDirty(ActiveEquipment);
 
+		FlushActiveSlotChangeMessages();
+
 		return true;
 	}
 
@@ -459,13 +1459,11 @@ void FActiveEquipmentContainer::UnequipEquipment(const FActiveEquipmentHandle& H
 
 	// Find equipment
 
-	for (auto& Entry : Entries)
+	const auto Index{ FindEntryIndex(Handle) };
+
+	if (Index != INDEX_NONE)
 	{
-		if (Entry.Handle == Handle)
-		{
-			UnequipEquipment(Entry);
-			return;
-		}
+		UnequipEquipment(Entries[Index]);
 	}
 }
 
@@ -480,23 +1478,23 @@ void FActiveEquipmentContainer::UnequipEquipment(const FGameplayTag& SlotTag)
 
 	// Find equipment
 
-	for (auto& Entry : Entries)
+	const auto Index{ FindEntryIndex(SlotTag) };
+
+	if (Index != INDEX_NONE)
 	{
-		if (Entry.Slot == SlotTag)
-		{
-			UnequipEquipment(Entry);
-			return;
-		}
+		UnequipEquipment(Entries[Index]);
 	}
 }
 
 void FActiveEquipmentContainer::UnequipEquipment(FActiveEquipment& ActiveEquipment)
 {
-	if (ActiveEquipment.TryUnequip())
+	if (TryUnequipEntry(ActiveEquipment))
 	{
 		HandleEquipmentUnequiped(ActiveEquipment);
 
 		MarkItemDirty(ActiveEquipment);
+
+		FlushActiveSlotChangeMessages();
 	}
 }
 
@@ -522,6 +1520,8 @@ void FActiveEquipmentContainer::HandleInitialized()
 
 		PendingGivenHandles.Empty();
 		PendingEquipedHandles.Empty();
+
+		FlushActiveSlotChangeMessages();
 	}
 }
 
@@ -558,9 +1558,19 @@ void FActiveEquipmentContainer::HandleEquipmentGiven(FActiveEquipment& ActiveEqu
 	auto Instance{ ActiveEquipment.Instance };
 	check(Instance);
 
+	// Keep the assets of the item from being evicted while it is in use
+
+	if (auto* Registry{ UEquipmentAssetRegistrySubsystem::Get(Owner) })
+	{
+		Registry->AcquireEquipment(ActiveEquipment.ItemData);
+		ActiveEquipment.bAcquiredAssets = true;
+	}
+
 	Instance->HandleEquipmentGiven();
 
-	BroadcastSlotChangeMessage(ActiveEquipment.Slot, ActiveEquipment.ItemData, ActiveEquipment.Instance);
+	ChangeLog.Add(EEquipmentChangeLogType::Added, ActiveEquipment.Handle, ActiveEquipment.Slot);
+
+	BroadcastSlotChangeMessage(ActiveEquipment.Slot, ActiveEquipment.ItemData, ActiveEquipment.Instance, ActiveEquipment.Handle, ActiveEquipment.SlotIndex);
 }
 
 void FActiveEquipmentContainer::HandleEquipmentRemove(FActiveEquipment& ActiveEquipment)
@@ -576,7 +1586,19 @@ void FActiveEquipmentContainer::HandleEquipmentRemove(FActiveEquipment& ActiveEq
 		Instance->HandleEquipmentRemove();
 	}
 
-	BroadcastSlotChangeMessage(ActiveEquipment.Slot, nullptr, nullptr);
+	if (ActiveEquipment.bAcquiredAssets)
+	{
+		ActiveEquipment.bAcquiredAssets = false;
+
+		if (auto* Registry{ UEquipmentAssetRegistrySubsystem::Get(Owner) })
+		{
+			Registry->ReleaseEquipment(ActiveEquipment.ItemData);
+		}
+	}
+
+	ChangeLog.Add(EEquipmentChangeLogType::Removed, ActiveEquipment.Handle, ActiveEquipment.Slot);
+
+	BroadcastSlotChangeMessage(ActiveEquipment.Slot, nullptr, nullptr, FActiveEquipmentHandle(), ActiveEquipment.SlotIndex);
 }
 
 void FActiveEquipmentContainer::HandleEquipmentEquiped(FActiveEquipment& ActiveEquipment)
@@ -594,7 +1616,9 @@ void FActiveEquipmentContainer::HandleEquipmentEquiped(FActiveEquipment& ActiveE
 	{
 		Instance->HandleEquiped();
 
-		BroadcastSlotChangeMessage(ActiveEquipment.Slot, ActiveEquipment.ItemData, ActiveEquipment.Instance);
+		ChangeLog.Add(EEquipmentChangeLogType::Equipped, ActiveEquipment.Handle, ActiveEquipment.Slot);
+
+		BroadcastSlotChangeMessage(ActiveEquipment.Slot, ActiveEquipment.ItemData, ActiveEquipment.Instance, ActiveEquipment.Handle, ActiveEquipment.SlotIndex);
 	}
 }
 
@@ -611,23 +1635,26 @@ void FActiveEquipmentContainer::HandleEquipmentUnequiped(FActiveEquipment& Activ
 	if (Instance && !ActiveEquipment.bEquiped)
 	{
 		Instance->HandleUnequiped();
+
+		ChangeLog.Add(EEquipmentChangeLogType::Unequipped, ActiveEquipment.Handle, ActiveEquipment.Slot);
 	}
 }
 
 
-bool FActiveEquipmentContainer::GetActiveSlotInfo(FEquipmentSlotChangedMessage& SlotInfo) const
+bool FActiveEquipmentContainer::GetActiveSlotInfo(FEquipmentSlotChangedMessage& SlotInfo, int32 GroupIndex) const
 {
-	for (const auto& Entry : Entries)
+	const auto Index{ ActiveHandles.IsValidIndex(GroupIndex) ? FindEntryIndex(ActiveHandles[GroupIndex]) : INDEX_NONE };
+
+	if (Index != INDEX_NONE)
 	{
-		if (Entry.bEquiped)
-		{
-			SlotInfo.OwnerComponent = OwnerComponent;
-			SlotInfo.SlotTag = Entry.Slot;
-			SlotInfo.Data = Entry.ItemData;
-			SlotInfo.Instance = Entry.Instance;
+		const auto& Entry{ Entries[Index] };
 
-			return true;
-		}
+		SlotInfo.OwnerComponent = OwnerComponent;
+		SlotInfo.SlotTag = Entry.Slot;
+		SlotInfo.Data = Entry.ItemData;
+		SlotInfo.Instance = Entry.Instance;
+
+		return true;
 	}
 
 	return false;
@@ -635,24 +1662,47 @@ bool FActiveEquipmentContainer::GetActiveSlotInfo(FEquipmentSlotChangedMessage&
 
 bool FActiveEquipmentContainer::GetSlotInfo(const FGameplayTag& SlotTag, FEquipmentSlotChangedMessage& SlotInfo) const
 {
-	for (const auto& Entry : Entries)
+	const auto Index{ FindEntryIndex(SlotTag) };
+
+	if (Index != INDEX_NONE)
 	{
-		if (Entry.Slot == SlotTag)
-		{
-			SlotInfo.OwnerComponent = OwnerComponent;
-			SlotInfo.SlotTag = Entry.Slot;
-			SlotInfo.Data = Entry.ItemData;
-			SlotInfo.Instance = Entry.Instance;
+		const auto& Entry{ Entries[Index] };
 
-			return true;
-		}
+		SlotInfo.OwnerComponent = OwnerComponent;
+		SlotInfo.SlotTag = Entry.Slot;
+		SlotInfo.Data = Entry.ItemData;
+		SlotInfo.Instance = Entry.Instance;
+
+		return true;
 	}
 
 	return false;
 }
 
 
-void FActiveEquipmentContainer::BroadcastSlotChangeMessage(FGameplayTag SlotTag, const UItemData* ItemData, UEquipment* Instance)
+void FActiveEquipmentContainer::BroadcastSlotChangeMessage(FGameplayTag SlotTag, const UItemData* ItemData, UEquipment* Instance, const FActiveEquipmentHandle& Handle, int32 SlotIndex)
+{
+	check(Owner);
+	check(OwnerComponent);
+
+	// Only record the slot while applying a change set or until the end of frame
+
+	if (bApplyingChangeSet || bDeferSlotMessagesToEndOfFrame)
+	{
+		PendingSlotMessages.AddUnique(SlotTag);
+
+		if (bDeferSlotMessagesToEndOfFrame)
+		{
+			OwnerComponent->RequestFlushSlotChangeMessages();
+		}
+
+		return;
+	}
+
+	SendSlotChangeMessage(SlotTag, ItemData, Instance, Handle, SlotIndex);
+}
+
+void FActiveEquipmentContainer::SendSlotChangeMessage(FGameplayTag SlotTag, const UItemData* ItemData, UEquipment* Instance, const FActiveEquipmentHandle& Handle, int32 SlotIndex)
 {
 	check(Owner);
 	check(OwnerComponent);
@@ -668,11 +1718,19 @@ void FActiveEquipmentContainer::BroadcastSlotChangeMessage(FGameplayTag SlotTag,
 		auto& MessageSystem{ UGameplayMessageSubsystem::Get(OwnerComponent->GetWorld()) };
 		MessageSystem.BroadcastMessage(TAG_Message_Equipment_SlotChange, Message);
 
-		OwnerComponent->OnEquipmentSlotChange.Broadcast(Message);
+		FEquipmentSlotChangedNativeMessage NativeMessage;
+		NativeMessage.OwnerComponent = OwnerComponent;
+		NativeMessage.Handle = Handle;
+		NativeMessage.SlotTag = SlotTag;
+		NativeMessage.SlotIndex = SlotIndex;
+		NativeMessage.Data = ItemData;
+		NativeMessage.Instance = Instance;
+
+		BroadcastSlotEventDelegates(OwnerComponent->OnEquipmentSlotChangeNative, OwnerComponent->OnEquipmentSlotChange, Message, NativeMessage, &OwnerComponent->GetSlotChangeListeners());
 	}
 }
 
-void FActiveEquipmentContainer::BroadcastActiveSlotChangeMessage(FGameplayTag SlotTag, const UItemData* ItemData, UEquipment* Instance)
+void FActiveEquipmentContainer::BroadcastActiveSlotChangeMessage(FGameplayTag SlotTag, const UItemData* ItemData, UEquipment* Instance, const FActiveEquipmentHandle& Handle, int32 SlotIndex)
 {
 	check(Owner);
 	check(OwnerComponent);
@@ -688,7 +1746,111 @@ void FActiveEquipmentContainer::BroadcastActiveSlotChangeMessage(FGameplayTag Sl
 		auto& MessageSystem{ UGameplayMessageSubsystem::Get(OwnerComponent->GetWorld()) };
 		MessageSystem.BroadcastMessage(TAG_Message_Equipment_ActiveSlotChange, Message);
 
-		OwnerComponent->OnActiveEquipmentSlotChange.Broadcast(Message);
+		FEquipmentSlotChangedNativeMessage NativeMessage;
+		NativeMessage.OwnerComponent = OwnerComponent;
+		NativeMessage.Handle = Handle;
+		NativeMessage.SlotTag = SlotTag;
+		NativeMessage.SlotIndex = SlotIndex;
+		NativeMessage.Data = ItemData;
+		NativeMessage.Instance = Instance;
+
+		BroadcastSlotEventDelegates(OwnerComponent->OnActiveEquipmentSlotChangeNative, OwnerComponent->OnActiveEquipmentSlotChange, Message, NativeMessage);
+	}
+}
+
+void FActiveEquipmentContainer::BroadcastSlotEventDelegates(
+	const FEquipmentSlotNativeEventDelegate& NativeDelegate
+	, const FEquipmentSlotEventDelegate& DynamicDelegate
+	, const FEquipmentSlotChangedMessage& Message
+	, const FEquipmentSlotChangedNativeMessage& NativeMessage
+	, const FEquipmentSlotListeners* SlotListeners) const
+{
+	// Native listeners receive the raw pointers and slot index of the entry without weak pointer resolution
+
+	NativeDelegate.Broadcast(NativeMessage);
+
+	if (SlotListeners && !SlotListeners->IsEmpty())
+	{
+		SlotListeners->Broadcast(NativeMessage);
+	}
+
+	// Skip the reflection based invocation if no Blueprint listener is bound
+
+	if (DynamicDelegate.IsBound())
+	{
+		DynamicDelegate.Broadcast(Message);
+	}
+}
+
+void FActiveEquipmentContainer::FlushActiveSlotChangeMessages()
+{
+	// Suspend while changes are being applied or until initialized
+
+	if (bApplyingChangeSet || bDeferActiveSlotMessages || !bInitalized)
+	{
+		return;
+	}
+
+	NotifiedActiveHandles.SetNum(ActiveHandles.Num());
+	NotifiedActiveSlots.SetNum(ActiveHandles.Num());
+
+	// Send only for the groups whose equipped entry has really changed since the last message
+
+	for (auto GroupIndex{ 0 }; GroupIndex < ActiveHandles.Num(); ++GroupIndex)
+	{
+		const auto& NewActiveHandle{ ActiveHandles[GroupIndex] };
+
+		if (NewActiveHandle == NotifiedActiveHandles[GroupIndex])
+		{
+			continue;
+		}
+
+		NotifiedActiveHandles[GroupIndex] = NewActiveHandle;
+
+		const auto Index{ FindEntryIndex(NewActiveHandle) };
+
+		if (Index != INDEX_NONE)
+		{
+			const auto& Entry{ Entries[Index] };
+
+			NotifiedActiveSlots[GroupIndex] = Entry.Slot;
+
+			BroadcastActiveSlotChangeMessage(Entry.Slot, Entry.ItemData, Entry.Instance, Entry.Handle, Entry.SlotIndex);
+		}
+		else
+		{
+			// Send the slot that was equipped with no data when nothing is equipped in the group
+
+			const auto& ClearedSlot{ NotifiedActiveSlots[GroupIndex] };
+
+			BroadcastActiveSlotChangeMessage(ClearedSlot, nullptr, nullptr, FActiveEquipmentHandle(), SlotLayout ? SlotLayout->FindSlotIndex(ClearedSlot) : INDEX_NONE);
+
+			NotifiedActiveSlots[GroupIndex] = FGameplayTag::EmptyTag;
+		}
+	}
+}
+
+void FActiveEquipmentContainer::FlushSlotChangeMessages()
+{
+	// Send the final state of each recorded slot
+
+	const auto SlotTags{ MoveTemp(PendingSlotMessages) };
+	PendingSlotMessages.Reset();
+
+	for (const auto& SlotTag : SlotTags)
+	{
+		const auto Index{ FindEntryIndex(SlotTag) };
+
+		if (Index != INDEX_NONE)
+		{
+			const auto& Entry{ Entries[Index] };
+
+			SendSlotChangeMessage(Entry.Slot, Entry.ItemData, Entry.Instance, Entry.Handle, Entry.SlotIndex);
+		}
+		else
+		{
+			SendSlotChangeMessage(SlotTag, nullptr, nullptr, FActiveEquipmentHandle(), SlotLayout ? SlotLayout->FindSlotIndex(SlotTag) : INDEX_NONE);
+		}
 	}
 }
 
@@ -5,7 +5,9 @@
 #include "Net/Serialization/FastArraySerializer.h"
 
 #include "Equipment/ActiveEquipmentHandle.h"
+#include "Type/EquipmentChangeLogTypes.h"
 #include "Type/EquipmentMessageTypes.h"
+#include "Type/EquipmentSlotRuleTypes.h"
 
 #include "GameplayTagContainer.h"
 
@@ -14,10 +16,17 @@
 class UItemData;
 class UEquipment;
 class UEquipmentManagerComponent;
+class UItemInfo_Equipment;
+class UEquipmentSlotLayout;
+struct FEquipmentChangeSet;
 
 
 /**
  * Data on added equipment items
+ * 
+ * Note:
+ *	This item is replicated only by the hand-written NetSerialize() instead of property replication.
+ *	A new replicated UPROPERTY must also be written in NetSerialize(), otherwise it will not be replicated.
  */
 USTRUCT(BlueprintType)
 struct FActiveEquipment : public FFastArraySerializerItem
@@ -43,6 +52,12 @@ protected:
 	UPROPERTY()
 	FGameplayTag Slot;
 
+	//
+	// Index of the slot in the slot layout of the owner component (INDEX_NONE if it has no layout)
+	//
+	UPROPERTY()
+	int32 SlotIndex{ INDEX_NONE };
+
 	//
 	// Item data for this equipment item
 	//
@@ -61,6 +76,30 @@ protected:
 	UPROPERTY()
 	uint8 bEquiped : 1 { false };
 
+	//
+	// Whether this entry is waiting to be compacted out of the container
+	//
+	UPROPERTY(NotReplicated)
+	uint8 bPendingRemove : 1 { false };
+
+	//
+	// Equip state last applied by the replication callbacks (only used on clients)
+	// 
+	// Tips:
+	//	Used to dispatch equip and unequip only on real transitions when other properties of the item change.
+	//
+	uint8 bReplicatedEquiped : 1 { false };
+
+	//
+	// Whether this entry holds a live reference on the equipment asset registry
+	//
+	uint8 bAcquiredAssets : 1 { false };
+
+	//
+	// Slot rules of this entry compiled into bit masks (only built on authority)
+	//
+	FEquipmentSlotRuleMasks RuleMasks;
+
 protected:
 	/**
 	 * Check if it is possible to equip it, and if so, equip it.
@@ -80,6 +119,11 @@ protected:
 
 
 public:
+	/**
+	 * Serialize the slot index instead of the slot tag if the entry is stored in a slot layout
+	 */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
 	/**
 	 * Returns debug string of this
 	 */
@@ -92,6 +136,12 @@ public:
 
 };
 
+template<>
+struct TStructOpsTypeTraits<FActiveEquipment> : public TStructOpsTypeTraitsBase2<FActiveEquipment>
+{
+	enum { WithNetSerializer = true };
+};
+
 
 /**
  * List of ActiveEquipment
@@ -106,7 +156,22 @@ struct FActiveEquipmentContainer : public FFastArraySerializer
 public:
 	FActiveEquipmentContainer() {}
 
-	void RegisterOwner(AActor* InOwner, UEquipmentManagerComponent* InOwnerComponent);
+	void RegisterOwner(AActor* InOwner, UEquipmentManagerComponent* InOwnerComponent, const UEquipmentSlotLayout* InSlotLayout = nullptr);
+
+	/**
+	 * Returns the handle table that can be used to validate handles from any thread
+	 */
+	TSharedPtr<const FActiveEquipmentHandleTable, ESPMode::ThreadSafe> GetHandleTable() const { return HandleTable; }
+
+	/**
+	 * Set whether slot change messages are collapsed per slot and sent with the final state at the end of frame
+	 */
+	void SetDeferSlotMessagesToEndOfFrame(bool bDefer) { bDeferSlotMessagesToEndOfFrame = bDefer; }
+
+	/**
+	 * Returns the log of changes applied to the entries for incremental consumers
+	 */
+	const FEquipmentChangeLog& GetChangeLog() const { return ChangeLog; }
 
 protected:
 	//
@@ -145,11 +210,112 @@ protected:
 	UPROPERTY(NotReplicated)
 	TSet<FActiveEquipmentHandle> PendingEquipedHandles;
 
+	//
+	// Index of the entry in Entries for each slot
+	//
+	UPROPERTY(NotReplicated)
+	TMap<FGameplayTag, int32> SlotToIndex;
+
+	//
+	// Fixed set of slots of the owner component (dynamic slots are used if not set)
+	//
+	UPROPERTY(NotReplicated)
+	TObjectPtr<const UEquipmentSlotLayout> SlotLayout{ nullptr };
+
+	//
+	// Index of the entry in Entries for each slot index of the slot layout
+	//
+	UPROPERTY(NotReplicated)
+	TArray<int32> LayoutSlotToEntry;
+
+	//
+	// Index of the entry in Entries for each index of handle
+	//
+	UPROPERTY(NotReplicated)
+	TArray<int32> HandleIndexToEntry;
+
+	//
+	// Table of handle generations shared with other threads
+	//
+	TSharedPtr<FActiveEquipmentHandleTable, ESPMode::ThreadSafe> HandleTable;
+
+	//
+	// Handle of the currently equipped entry for each active group of the slot layout
+	//
+	UPROPERTY(NotReplicated)
+	TArray<FActiveEquipmentHandle> ActiveHandles{ FActiveEquipmentHandle() };
+
+	//
+	// Handle of the equipped entry last notified for each active group
+	//
+	UPROPERTY(NotReplicated)
+	TArray<FActiveEquipmentHandle> NotifiedActiveHandles;
+
+	//
+	// Slot of the equipped entry last notified for each active group
+	//
+	UPROPERTY(NotReplicated)
+	TArray<FGameplayTag> NotifiedActiveSlots;
+
+	//
+	// Whether active slot change messages are deferred until the current operation is complete
+	//
+	UPROPERTY(NotReplicated)
+	bool bDeferActiveSlotMessages{ false };
+
+	//
+	// Whether the index caches need to be rebuilt because Entries was reordered by replication
+	//
+	UPROPERTY(NotReplicated)
+	bool bIndicesDirty{ false };
+
+	//
+	// Whether a change set is being applied and slot change messages are being deferred
+	//
+	UPROPERTY(NotReplicated)
+	bool bApplyingChangeSet{ false };
+
+	//
+	// List of slots whose change message is deferred until the change set is applied
+	//
+	UPROPERTY(NotReplicated)
+	TArray<FGameplayTag> PendingSlotMessages;
+
+	//
+	// Whether slot change messages are collapsed per slot and sent at the end of frame
+	//
+	UPROPERTY(NotReplicated)
+	bool bDeferSlotMessagesToEndOfFrame{ false };
+
+	//
+	// Versioned log of the recent changes applied on this machine
+	// 
+	// Tips:
+	//	Not replicated. Each machine records the changes as they are applied locally.
+	//
+	FEquipmentChangeLog ChangeLog;
+
+	//
+	// Union of the slot rule masks of all entries to test conflicts with a few word operations
+	//
+	FEquipmentSlotRuleMasks CombinedRuleMasks;
+
+	//
+	// Serial of the slot index registry the rule masks of entries were built with
+	//
+	uint32 RuleMasksSerial{ 0 };
+
+	//
+	// Whether CombinedRuleMasks needs to be rebuilt because entries were changed
+	//
+	bool bRuleMasksDirty{ true };
+
 
 public:
 	void PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize);
 	void PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize);
 	void PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize);
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
 
 	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
 	{
@@ -157,6 +323,26 @@ public:
 	}
 
 
+protected:
+	void RebuildIndices();
+	void AddEntryToIndices(int32 Index);
+	void RemoveEntryAt(int32 Index);
+	void UnindexEntry(const FActiveEquipment& Entry);
+	void RemoveEntryDeferred(int32 Index);
+	void CompactPendingRemoveEntries();
+
+	int32 FindEntryIndex(const FActiveEquipmentHandle& Handle) const;
+	int32 FindEntryIndex(const FGameplayTag& SlotTag) const;
+	int32 FindEntryIndexBySlotIndex(int32 SlotIndex) const;
+	void SetSlotEntryIndex(const FActiveEquipment& Entry, int32 Index);
+
+	int32 GetActiveGroupIndex(const FActiveEquipment& Entry) const;
+	int32 GetActiveGroupIndex(const FGameplayTag& InSlotTag) const;
+
+	bool TryEquipEntry(FActiveEquipment& ActiveEquipment);
+	bool TryUnequipEntry(FActiveEquipment& ActiveEquipment);
+
+
 public:
 	void HandleInitialized();
 
@@ -168,13 +354,33 @@ protected:
 
 
 public:
-	bool AddEquipmentItem(const FGameplayTag& InSlotTag, const UItemData* InItemData, FActiveEquipmentHandle& OutHandle, bool bEquipImmediately = false);
+	/**
+	 * Add the equipment item to the slot
+	 * 
+	 * Note:
+	 *	If bEquipImmediately is true, the entry currently equipped in the same active group is unequipped
+	 *	before the new entry is equipped, so that a group never has more than one equipped entry.
+	 * 
+	 * Tips:
+	 *	If InEquipmentClass is set, it is added as is instead of resolving the class again, e.g. after streaming it in.
+	 */
+	bool AddEquipmentItem(const FGameplayTag& InSlotTag, const UItemData* InItemData, FActiveEquipmentHandle& OutHandle, bool bEquipImmediately = false, FName ResolveContext = NAME_None, TSubclassOf<UEquipment> InEquipmentClass = nullptr);
+
+	void ApplyChangeSet(const FEquipmentChangeSet& ChangeSet, TArray<FActiveEquipmentHandle>& OutAddedHandles);
 
 	void RemoveEquipmentItem(const FActiveEquipmentHandle& Handle);
 	void RemoveEquipmentItem(const FGameplayTag& SlotTag);
 	void RemoveMultipleEquipmentItems(const TSet<FActiveEquipmentHandle>& Handles);
 	void RemoveAllEquipmentItem();
 
+	/**
+	 * Release the live references held on the equipment asset registry by all entries
+	 * 
+	 * Tips:
+	 *	Must be called when the owner is torn down, since entries are not removed through the replication callbacks then.
+	 */
+	void ReleaseAll();
+
 	bool EquipEquipment(const FActiveEquipmentHandle& Handle);
 	bool EquipEquipment(const FGameplayTag& SlotTag);
 	bool EquipEquipment(FActiveEquipment& ActiveEquipment);
@@ -183,6 +389,38 @@ public:
 	void UnequipEquipment(const FGameplayTag& SlotTag);
 	void UnequipEquipment(FActiveEquipment& ActiveEquipment);
 
+protected:
+	const FEquipmentSlotRules* FindItemSlotRules(const UItemData* InItemData) const;
+	const FEquipmentSlotRules* FindLayoutSlotRules(int32 InSlotIndex) const;
+	void BuildRuleMasks(FActiveEquipment& Entry) const;
+	void UpdateRuleMasks();
+
+	/**
+	 * Gather entries to be removed by slot rules when the item is added to the slot
+	 * 
+	 * Tips:
+	 *	Returns false if the required slots of the item are not occupied.
+	 */
+	bool GatherAddConflicts(const FGameplayTag& InSlotTag, const UItemData* InItemData, TArray<int32>& OutRemoveIndices);
+
+	/**
+	 * Unequip the equipped entries that cannot be equipped together with the entry by slot rules
+	 */
+	void UnequipConflictingEntries(int32 Index, TArray<FActiveEquipmentHandle>& OutUnequipedHandles);
+
+	/**
+	 * Returns the index of an entry whose required slots are no longer occupied
+	 */
+	int32 FindUnsatisfiedEntryIndex();
+
+	bool HasRequiredSlots();
+
+protected:
+	const UItemInfo_Equipment* FindEquipmentInfo(const FGameplayTag& InSlotTag, const UItemData* InItemData) const;
+	TSubclassOf<UEquipment> ResolveEquipmentClass(const FGameplayTag& InSlotTag, const UItemData* InItemData, FName ResolveContext = NAME_None, TSubclassOf<UEquipment> InEquipmentClass = nullptr) const;
+	TSoftClassPtr<UEquipment> ResolveSoftEquipmentClass(const FGameplayTag& InSlotTag, const UItemData* InItemData, FName ResolveContext = NAME_None) const;
+	int32 AddEntry(const FGameplayTag& InSlotTag, const UItemData* InItemData, TSubclassOf<UEquipment> EquipmentClass);
+
 protected:
 	void HandleEquipmentGiven(FActiveEquipment& ActiveEquipment);
 	void HandleEquipmentRemove(FActiveEquipment& ActiveEquipment);
@@ -191,19 +429,49 @@ protected:
 	void HandleEquipmentUnequiped(FActiveEquipment& ActiveEquipment);
 
 public:
-	bool GetActiveSlotInfo(FEquipmentSlotChangedMessage& SlotInfo) const;
+	bool GetActiveSlotInfo(FEquipmentSlotChangedMessage& SlotInfo, int32 GroupIndex = 0) const;
 	bool GetSlotInfo(const FGameplayTag& SlotTag, FEquipmentSlotChangedMessage& SlotInfo) const;
 
 protected:
 	void BroadcastSlotChangeMessage(
 		FGameplayTag SlotTag = FGameplayTag::EmptyTag
 		, const UItemData* ItemData = nullptr
-		, UEquipment* Instance = nullptr);
+		, UEquipment* Instance = nullptr
+		, const FActiveEquipmentHandle& Handle = FActiveEquipmentHandle()
+		, int32 SlotIndex = INDEX_NONE);
+
+	void SendSlotChangeMessage(
+		FGameplayTag SlotTag = FGameplayTag::EmptyTag
+		, const UItemData* ItemData = nullptr
+		, UEquipment* Instance = nullptr
+		, const FActiveEquipmentHandle& Handle = FActiveEquipmentHandle()
+		, int32 SlotIndex = INDEX_NONE);
 
 	void BroadcastActiveSlotChangeMessage(
 		FGameplayTag SlotTag = FGameplayTag::EmptyTag
 		, const UItemData* ItemData = nullptr
-		, UEquipment* Instance = nullptr);
+		, UEquipment* Instance = nullptr
+		, const FActiveEquipmentHandle& Handle = FActiveEquipmentHandle()
+		, int32 SlotIndex = INDEX_NONE);
+
+	void BroadcastSlotEventDelegates(
+		const FEquipmentSlotNativeEventDelegate& NativeDelegate
+		, const FEquipmentSlotEventDelegate& DynamicDelegate
+		, const FEquipmentSlotChangedMessage& Message
+		, const FEquipmentSlotChangedNativeMessage& NativeMessage
+		, const FEquipmentSlotListeners* SlotListeners = nullptr) const;
+
+public:
+	/**
+	 * Send the final state of each slot whose change message was deferred
+	 */
+	void FlushSlotChangeMessages();
+
+protected:
+	/**
+	 * Send the active slot change message for each active group whose equipped entry has changed since the last message
+	 */
+	void FlushActiveSlotChangeMessages();
 
 };
 
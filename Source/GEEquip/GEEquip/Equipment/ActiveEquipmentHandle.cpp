@@ -5,10 +5,83 @@
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ActiveEquipmentHandle)
 
 
-void FActiveEquipmentHandle::GenerateNewHandle()
+FActiveEquipmentHandleTable::FActiveEquipmentHandleTable()
+{
+	for (uint32 Index{ 0 }; Index < FActiveEquipmentHandle::MaxIndex; ++Index)
+	{
+		LiveGenerations[Index].store(0, std::memory_order_relaxed);
+	}
+}
+
+
+uint32 FActiveEquipmentHandleTable::NewGeneration()
 {
 	// Must be in C++ to avoid duplicate statics accross execution units
 
-	static int32 GHandle{ 1 };
-	Handle = GHandle++;
+	static std::atomic<uint32> GGeneration{ 0 };
+
+	// Wrap without using 0, after which generations repeat across all tables
+
+	uint32 Generation{ 0 };
+
+	while (Generation == 0)
+	{
+		Generation = (GGeneration.fetch_add(1, std::memory_order_relaxed) + 1) & FActiveEquipmentHandle::MaxGeneration;
+	}
+
+	return Generation;
+}
+
+FActiveEquipmentHandle FActiveEquipmentHandleTable::Allocate()
+{
+	const auto Generation{ NewGeneration() };
+
+	// Claim the first free index after the last allocated one
+
+	const auto StartIndex{ SearchStartIndex.load(std::memory_order_relaxed) };
+
+	for (uint32 Offset{ 0 }; Offset < FActiveEquipmentHandle::MaxIndex; ++Offset)
+	{
+		const auto Index{ (StartIndex + Offset) & FActiveEquipmentHandle::IndexMask };
+
+		uint32 FreeGeneration{ 0 };
+
+		if (LiveGenerations[Index].compare_exchange_strong(FreeGeneration, Generation, std::memory_order_acq_rel, std::memory_order_relaxed))
+		{
+			SearchStartIndex.store((Index + 1) & FActiveEquipmentHandle::IndexMask, std::memory_order_relaxed);
+
+			return FActiveEquipmentHandle(Index, Generation);
+		}
+	}
+
+	// All indices are in use
+
+	return FActiveEquipmentHandle();
+}
+
+void FActiveEquipmentHandleTable::Release(const FActiveEquipmentHandle& Handle)
+{
+	Unassign(Handle);
+}
+
+void FActiveEquipmentHandleTable::Assign(const FActiveEquipmentHandle& Handle)
+{
+	if (Handle.IsValid())
+	{
+		LiveGenerations[Handle.GetIndex()].store(Handle.GetGeneration(), std::memory_order_release);
+	}
+}
+
+void FActiveEquipmentHandleTable::Unassign(const FActiveEquipmentHandle& Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return;
+	}
+
+	// Free the index only if it is still alive with the generation of the handle
+
+	auto AliveGeneration{ Handle.GetGeneration() };
+
+	LiveGenerations[Handle.GetIndex()].compare_exchange_strong(AliveGeneration, 0, std::memory_order_acq_rel, std::memory_order_relaxed);
 }
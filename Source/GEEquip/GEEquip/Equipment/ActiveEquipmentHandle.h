@@ -2,43 +2,67 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "ActiveEquipmentHandle.generated.h"
 
 
 /**
  * Handle that points to a specific appling equipment.
- * 
+ *
  * Tips:
- *	These are globally unique
+ *	Packs the index of the slot in the owning container's handle table and its generation.
+ *	A handle is only valid while the generation of its index in the table matches.
+ *	Generations are drawn from a 24 bit counter shared by all tables, so a handle is only unique
+ *	for its index within one wrap of the counter (about 16 million allocations across all containers).
+ *	After the counter wraps, a stale handle may match a newer one, so do not keep handles for the whole
+ *	lifetime of a long running server; passing a handle to another container is caught by comparing the entry.
  */
 USTRUCT(BlueprintType)
 struct FActiveEquipmentHandle
 {
 	GENERATED_BODY()
 public:
-	FActiveEquipmentHandle() : Handle(INDEX_NONE) {}
+	static constexpr uint32 IndexBits{ 8 };
+	static constexpr uint32 MaxIndex{ 1u << IndexBits };
+	static constexpr uint32 IndexMask{ MaxIndex - 1 };
+	static constexpr uint32 MaxGeneration{ MAX_uint32 >> IndexBits };
 
-	/** 
-	 * Sets this to a valid handle 
-	 */
-	void GenerateNewHandle();
+public:
+	FActiveEquipmentHandle() : Handle(0) {}
+	FActiveEquipmentHandle(uint32 InIndex, uint32 InGeneration)
+		: Handle(((InGeneration & MaxGeneration) << IndexBits) | (InIndex & IndexMask))
+	{}
 
 private:
 	//
-	// Unique handle indexing
+	// Packed index (low bits) and generation (high bits)
 	//
 	UPROPERTY()
-	int32 Handle;
+	uint32 Handle;
 
 public:
 	bool operator==(const FActiveEquipmentHandle& Other) const { return Handle == Other.Handle; }
 	bool operator!=(const FActiveEquipmentHandle& Other) const { return Handle != Other.Handle; }
 
 public:
-	/** 
-	 * True if GenerateNewHandle was called on this handle 
+	/**
+	 * Returns the index of this handle in the handle table
+	 */
+	uint32 GetIndex() const { return Handle & IndexMask; }
+
+	/**
+	 * Returns the generation of this handle
+	 */
+	uint32 GetGeneration() const { return Handle >> IndexBits; }
+
+	/**
+	 * True if this handle was allocated from the handle table
+	 *
+	 * Tips:
+	 *	Generation 0 is never allocated
 	 */
-	bool IsValid() const { return Handle != INDEX_NONE; }
+	bool IsValid() const { return GetGeneration() != 0; }
 
 	/**
 	 * Returns a hash of this handle
@@ -48,6 +72,69 @@ public:
 	/**
 	 * Return this handle as string.
 	 */
-	FString ToString() const { return IsValid() ? FString::FromInt(Handle) : TEXT("Invalid"); }
+	FString ToString() const { return IsValid() ? FString::Printf(TEXT("%u:%u"), GetIndex(), GetGeneration()) : TEXT("Invalid"); }
+
+};
+
+
+/**
+ * Table of live generations for each index of FActiveEquipmentHandle
+ *
+ * Tips:
+ *	All functions are lock-free and can be called from any thread.
+ *	A free index is claimed by a compare-exchange on its live generation.
+ */
+class GEEQUIP_API FActiveEquipmentHandleTable
+{
+public:
+	FActiveEquipmentHandleTable();
+
+private:
+	//
+	// Generation currently alive at each index (0 if not in use)
+	//
+	std::atomic<uint32> LiveGenerations[FActiveEquipmentHandle::MaxIndex];
+
+	//
+	// Index to start searching for a free index from
+	//
+	std::atomic<uint32> SearchStartIndex{ 0 };
+
+	/**
+	 * Returns a new generation from the counter shared by all tables without using 0
+	 */
+	static uint32 NewGeneration();
+
+public:
+	/**
+	 * Allocate a new handle at a free index with a generation not reused by any table until the counter wraps
+	 *
+	 * Tips:
+	 *	Returns an invalid handle if all indices are in use
+	 */
+	FActiveEquipmentHandle Allocate();
+
+	/**
+	 * Invalidate the handle and make the index reusable
+	 */
+	void Release(const FActiveEquipmentHandle& Handle);
+
+	/**
+	 * Mark the replicated handle as alive without allocating it
+	 */
+	void Assign(const FActiveEquipmentHandle& Handle);
+
+	/**
+	 * Mark the replicated handle as no longer alive
+	 */
+	void Unassign(const FActiveEquipmentHandle& Handle);
+
+	/**
+	 * Returns whether the handle still points to a live entry
+	 */
+	bool IsAlive(const FActiveEquipmentHandle& Handle) const
+	{
+		return Handle.IsValid() && (LiveGenerations[Handle.GetIndex()].load(std::memory_order_acquire) == Handle.GetGeneration());
+	}
 
 };
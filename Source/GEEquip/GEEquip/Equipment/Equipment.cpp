@@ -56,6 +56,15 @@ EDataValidationResult UEquipment::IsDataValid(FDataValidationContext& Context) c
 
 	return Result;
 }
+
+void UEquipment::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Fragments may have been changed, so rebuild plans on next use
+
+	ExecutionPlans.Reset();
+}
 #endif // WITH_EDITOR
 
 
@@ -83,108 +92,145 @@ void UEquipment::RegisterReplicationFragments(UE::Net::FFragmentRegistrationCont
 #endif // UE_WITH_IRIS
 
 
-// Event
+// Fragments
 
-void UEquipment::HandleEquipmentGiven()
+#if WITH_EDITOR
+uint32 UEquipment::ExecutionPlanSerial{ 0 };
+#endif // WITH_EDITOR
+
+const FEquipmentFragmentExecutionPlan& UEquipment::GetExecutionPlan(EEquipmentNetContext NetContext) const
 {
-	auto* ActorOwner{ GetOwnerChecked<AActor>() };
-	const auto bHasAuthority{ ActorOwner->HasAuthority() };
-	const auto bIsDedicatedServer{ ActorOwner->IsNetMode(ENetMode::NM_DedicatedServer) };
-	const auto bIsLocallyControlled{ ActorOwner->HasLocalNetOwner() };
-	
-	UE_LOG(LogGameCore_Equipment, Log, TEXT("[%s|%s] OnGiven: %s")
-		, bHasAuthority ? TEXT("SERVER") : TEXT("CLIENT")
-		, bIsLocallyControlled ? TEXT("Local") : TEXT("NotLocal")
-		, *GetNameSafe(this));
+	const auto* CDO{ GetClass()->GetDefaultObject<UEquipment>() };
 
-	for (const auto& Fragment : Fragments)
+#if WITH_EDITOR
+	if (CDO->BuiltExecutionPlanSerial != ExecutionPlanSerial)
 	{
-		const auto ExecutionPolicy{ Fragment->GetNetExecutionPolicy() };
+		CDO->ExecutionPlans.Reset();
+		CDO->BuiltExecutionPlanSerial = ExecutionPlanSerial;
+	}
+#endif // WITH_EDITOR
 
-		if ((ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::Both)
-			|| (bHasAuthority && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::ServerOnly)
-			|| (bIsLocallyControlled && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::LocalOnly)
-			|| (!bIsDedicatedServer && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::ClientOnly))
-		{
-			Fragment->HandleEquipmentGiven();
-		}
+	if (CDO->ExecutionPlans.IsEmpty())
+	{
+		CDO->BuildExecutionPlans();
 	}
+
+	return CDO->ExecutionPlans[static_cast<uint8>(NetContext)];
 }
 
-void UEquipment::HandleEquipmentRemove()
+void UEquipment::BuildExecutionPlans() const
 {
-	auto* ActorOwner{ GetOwnerChecked<AActor>() };
-	const auto bHasAuthority{ ActorOwner->HasAuthority() };
-	const auto bIsDedicatedServer{ ActorOwner->IsNetMode(ENetMode::NM_DedicatedServer) };
-	const auto bIsLocallyControlled{ ActorOwner->HasLocalNetOwner() };
-
-	UE_LOG(LogGameCore_Equipment, Log, TEXT("[%s|%s] OnRemove: %s")
-		, bHasAuthority ? TEXT("SERVER") : TEXT("CLIENT")
-		, bIsLocallyControlled ? TEXT("Local") : TEXT("NotLocal")
-		, *GetNameSafe(this));
+	ExecutionPlans.SetNum(static_cast<uint8>(EEquipmentNetContext::MAX));
 
-	for (const auto& Fragment : Fragments)
+	for (uint8 ContextIndex{ 0 }; ContextIndex < static_cast<uint8>(EEquipmentNetContext::MAX); ++ContextIndex)
 	{
-		const auto ExecutionPolicy{ Fragment->GetNetExecutionPolicy() };
+		const auto NetContext{ static_cast<EEquipmentNetContext>(ContextIndex) };
+		auto& Plan{ ExecutionPlans[ContextIndex] };
 
-		if ((ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::Both)
-			|| (bHasAuthority && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::ServerOnly)
-			|| (bIsLocallyControlled && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::LocalOnly)
-			|| (!bIsDedicatedServer && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::ClientOnly))
+		for (auto It{ Fragments.CreateConstIterator() }; It; ++It)
 		{
-			Fragment->HandleEquipmentRemove();
+			const auto* Fragment{ It->Get() };
+
+			if (Fragment && ShouldExecuteEquipmentFragment(Fragment->GetNetExecutionPolicy(), NetContext))
+			{
+				for (uint8 EventIndex{ 0 }; EventIndex < static_cast<uint8>(EEquipmentFragmentEvent::MAX); ++EventIndex)
+				{
+					// Skip events that are not implemented either natively or in Blueprint
+
+					if (Fragment->ImplementsEvent(static_cast<EEquipmentFragmentEvent>(EventIndex)))
+					{
+						Plan.FragmentIndices[EventIndex].Add(It.GetIndex());
+					}
+				}
+			}
 		}
 	}
 }
 
-void UEquipment::HandleEquiped()
+EEquipmentNetContext UEquipment::GetNetContext() const
 {
 	auto* ActorOwner{ GetOwnerChecked<AActor>() };
-	const auto bHasAuthority{ ActorOwner->HasAuthority() };
-	const auto bIsDedicatedServer{ ActorOwner->IsNetMode(ENetMode::NM_DedicatedServer) };
-	const auto bIsLocallyControlled{ ActorOwner->HasLocalNetOwner() };
 
-	UE_LOG(LogGameCore_Equipment, Log, TEXT("[%s|%s] OnEquip: %s")
-		, bHasAuthority ? TEXT("SERVER") : TEXT("CLIENT")
-		, bIsLocallyControlled ? TEXT("Local") : TEXT("NotLocal")
-		, *GetNameSafe(this));
+	auto NetContext{ EEquipmentNetContext::None };
 
-	for (const auto& Fragment : Fragments)
+	if (ActorOwner->HasAuthority())
 	{
-		const auto ExecutionPolicy{ Fragment->GetNetExecutionPolicy() };
+		NetContext |= EEquipmentNetContext::Authority;
+	}
 
-		if ((ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::Both)
-			|| (bHasAuthority && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::ServerOnly)
-			|| (bIsLocallyControlled && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::LocalOnly)
-			|| (!bIsDedicatedServer && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::ClientOnly))
-		{
-			Fragment->HandleEquiped();
-		}
+	if (ActorOwner->HasLocalNetOwner())
+	{
+		NetContext |= EEquipmentNetContext::LocallyControlled;
+	}
+
+	if (ActorOwner->IsNetMode(ENetMode::NM_DedicatedServer))
+	{
+		NetContext |= EEquipmentNetContext::DedicatedServer;
 	}
+
+	return NetContext;
 }
 
-void UEquipment::HandleUnequiped()
+void UEquipment::ExecuteFragments(EEquipmentFragmentEvent Event)
 {
-	auto* ActorOwner{ GetOwnerChecked<AActor>() };
-	const auto bHasAuthority{ ActorOwner->HasAuthority() };
-	const auto bIsDedicatedServer{ ActorOwner->IsNetMode(ENetMode::NM_DedicatedServer) };
-	const auto bIsLocallyControlled{ ActorOwner->HasLocalNetOwner() };
+	using FFragmentEventFunc = void (UEquipmentFragment::*)();
 
-	UE_LOG(LogGameCore_Equipment, Log, TEXT("[%s|%s] OnUnequip: %s")
-		, bHasAuthority ? TEXT("SERVER") : TEXT("CLIENT")
-		, bIsLocallyControlled ? TEXT("Local") : TEXT("NotLocal")
-		, *GetNameSafe(this));
+	static const FFragmentEventFunc EventFuncs[static_cast<uint8>(EEquipmentFragmentEvent::MAX)]
+	{
+		&UEquipmentFragment::HandleEquipmentGiven,
+		&UEquipmentFragment::HandleEquipmentRemove,
+		&UEquipmentFragment::HandleEquiped,
+		&UEquipmentFragment::HandleUnequiped
+	};
 
-	for (const auto& Fragment : Fragments)
+	static const TCHAR* EventNames[static_cast<uint8>(EEquipmentFragmentEvent::MAX)]
 	{
-		const auto ExecutionPolicy{ Fragment->GetNetExecutionPolicy() };
+		TEXT("OnGiven"),
+		TEXT("OnRemove"),
+		TEXT("OnEquip"),
+		TEXT("OnUnequip")
+	};
+
+	// Resolve the net context once and walk the fragments listed for it
 
-		if ((ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::Both)
-			|| (bHasAuthority && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::ServerOnly)
-			|| (bIsLocallyControlled && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::LocalOnly)
-			|| (!bIsDedicatedServer && ExecutionPolicy == EEquipmentFragmentNetExecutionPolicy::ClientOnly))
+	const auto NetContext{ GetNetContext() };
+
+	UE_LOG(LogGameCore_Equipment, Log, TEXT("[%s|%s] %s: %s")
+		, EnumHasAnyFlags(NetContext, EEquipmentNetContext::Authority) ? TEXT("SERVER") : TEXT("CLIENT")
+		, EnumHasAnyFlags(NetContext, EEquipmentNetContext::LocallyControlled) ? TEXT("Local") : TEXT("NotLocal")
+		, EventNames[static_cast<uint8>(Event)]
+		, *GetNameSafe(this));
+
+	const auto EventFunc{ EventFuncs[static_cast<uint8>(Event)] };
+
+	for (const auto& Index : GetExecutionPlan(NetContext).GetFragmentIndices(Event))
+	{
+		if (auto* Fragment{ Fragments.IsValidIndex(Index) ? Fragments[Index].Get() : nullptr })
 		{
-			Fragment->HandleUnequiped();
+			(Fragment->*EventFunc)();
 		}
 	}
 }
+
+
+// Event
+
+void UEquipment::HandleEquipmentGiven()
+{
+	ExecuteFragments(EEquipmentFragmentEvent::Given);
+}
+
+void UEquipment::HandleEquipmentRemove()
+{
+	ExecuteFragments(EEquipmentFragmentEvent::Remove);
+}
+
+void UEquipment::HandleEquiped()
+{
+	ExecuteFragments(EEquipmentFragmentEvent::Equiped);
+}
+
+void UEquipment::HandleUnequiped()
+{
+	ExecuteFragments(EEquipmentFragmentEvent::Unequiped);
+}
@@ -13,6 +13,20 @@ class UEquipmentFragment;
 class UItemData;
 
 
+/**
+ * List of fragment indices to execute for each event in a specific net context
+ */
+struct FEquipmentFragmentExecutionPlan
+{
+public:
+	TArray<int32> FragmentIndices[static_cast<uint8>(EEquipmentFragmentEvent::MAX)];
+
+public:
+	const TArray<int32>& GetFragmentIndices(EEquipmentFragmentEvent Event) const { return FragmentIndices[static_cast<uint8>(Event)]; }
+
+};
+
+
 /**
  * Base class for the concept of equipment
  * 
@@ -31,6 +45,7 @@ public:
 public:
 #if WITH_EDITOR 
 	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif // WITH_EDITOR
 	
 
@@ -73,6 +88,57 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Instanced, Category = "Fragments")
 	TArray<TObjectPtr<UEquipmentFragment>> Fragments;
 
+public:
+	const TArray<TObjectPtr<UEquipmentFragment>>& GetFragments() const { return Fragments; }
+
+private:
+	//
+	// Fragment execution plans of this class for each net context
+	// 
+	// Tips:
+	//	Only built on the CDO and shared by all instances of the class
+	//
+	mutable TArray<FEquipmentFragmentExecutionPlan> ExecutionPlans;
+
+#if WITH_EDITOR
+	//
+	// Serial number incremented when objects are reinstanced in the editor, so that plans are rebuilt
+	//
+	static uint32 ExecutionPlanSerial;
+
+	//
+	// Serial number at the time the execution plans were built
+	//
+	mutable uint32 BuiltExecutionPlanSerial{ 0 };
+
+public:
+	/**
+	 * Invalidate the execution plans of all classes
+	 */
+	static void InvalidateExecutionPlans() { ++ExecutionPlanSerial; }
+#endif // WITH_EDITOR
+
+protected:
+	/**
+	 * Returns the execution plan of this class for the net context
+	 */
+	const FEquipmentFragmentExecutionPlan& GetExecutionPlan(EEquipmentNetContext NetContext) const;
+
+	/**
+	 * Build execution plans for all net contexts from the fragments of this CDO
+	 */
+	void BuildExecutionPlans() const;
+
+	/**
+	 * Returns current net context of the owner
+	 */
+	EEquipmentNetContext GetNetContext() const;
+
+	/**
+	 * Execute the event on the fragments listed in the execution plan
+	 */
+	void ExecuteFragments(EEquipmentFragmentEvent Event);
+
 
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Event
@@ -48,3 +48,71 @@ enum class EEquipmentEquipPolicy : uint8
 	//	For example, swords, guns, etc.
 	CanBeEquipped		UMETA(DisplayName = "Equipable")
 };
+
+
+/**
+ * Events of equipment that are dispatched to fragments
+ */
+enum class EEquipmentFragmentEvent : uint8
+{
+	Given,
+	Remove,
+	Equiped,
+	Unequiped,
+
+	MAX
+};
+
+/**
+ * Returns the bit of the event used in the event mask
+ */
+constexpr uint8 GetEquipmentFragmentEventBit(EEquipmentFragmentEvent Event) { return static_cast<uint8>(1 << static_cast<uint8>(Event)); }
+
+/**
+ * Event mask with all events
+ */
+constexpr uint8 EquipmentFragmentEventMask_All{ (1 << static_cast<uint8>(EEquipmentFragmentEvent::MAX)) - 1 };
+
+
+/**
+ * Net context of the equipment owner used to select the fragments to execute
+ * 
+ * Tips:
+ *	DedicatedServer		= Authority | DedicatedServer
+ *	ListenServer Host	= Authority | LocallyControlled
+ *	Autonomous Client	= LocallyControlled
+ *	Simulated Client	= None
+ */
+enum class EEquipmentNetContext : uint8
+{
+	None				= 0,
+	Authority			= 1 << 0,
+	LocallyControlled	= 1 << 1,
+	DedicatedServer		= 1 << 2,
+
+	MAX					= 1 << 3
+};
+ENUM_CLASS_FLAGS(EEquipmentNetContext);
+
+/**
+ * Returns whether fragments with the execution policy are executed in the net context
+ */
+inline bool ShouldExecuteEquipmentFragment(EEquipmentFragmentNetExecutionPolicy ExecutionPolicy, EEquipmentNetContext NetContext)
+{
+	switch (ExecutionPolicy)
+	{
+	case EEquipmentFragmentNetExecutionPolicy::Both:
+		return true;
+
+	case EEquipmentFragmentNetExecutionPolicy::ServerOnly:
+		return EnumHasAnyFlags(NetContext, EEquipmentNetContext::Authority);
+
+	case EEquipmentFragmentNetExecutionPolicy::LocalOnly:
+		return EnumHasAnyFlags(NetContext, EEquipmentNetContext::LocallyControlled);
+
+	case EEquipmentFragmentNetExecutionPolicy::ClientOnly:
+		return !EnumHasAnyFlags(NetContext, EEquipmentNetContext::DedicatedServer);
+	}
+
+	return false;
+}
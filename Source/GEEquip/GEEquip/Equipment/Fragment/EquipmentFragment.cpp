@@ -6,6 +6,7 @@
 #include "GEEquipLogs.h"
 
 #include "GameFramework/Actor.h"
+#include "Engine/BlueprintGeneratedClass.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentFragment)
 
@@ -16,32 +17,107 @@ UEquipmentFragment::UEquipmentFragment(const FObjectInitializer& ObjectInitializ
 }
 
 
+void UEquipmentFragment::ResolveImplementedEvents() const
+{
+	// Native events are only implemented when a native subclass overrides them
+
+	const auto* NativeClass{ GetClass() };
+
+	while (NativeClass && !NativeClass->HasAnyClassFlags(CLASS_Native))
+	{
+		NativeClass = NativeClass->GetSuperClass();
+	}
+
+	const auto NativeEvents{ (NativeClass == UEquipmentFragment::StaticClass()) ? 0 : NativeImplementedEvents };
+
+	// Blueprint events are only implemented when the function is owned by a Blueprint class
+
+	static const FName EventFuncNames[static_cast<uint8>(EEquipmentFragmentEvent::MAX)]
+	{
+		GET_FUNCTION_NAME_CHECKED(UEquipmentFragment, OnEquipmentGiven),
+		GET_FUNCTION_NAME_CHECKED(UEquipmentFragment, OnEquipmentRemove),
+		GET_FUNCTION_NAME_CHECKED(UEquipmentFragment, OnEquiped),
+		GET_FUNCTION_NAME_CHECKED(UEquipmentFragment, OnUnequiped)
+	};
+
+	uint8 BlueprintEvents{ 0 };
+
+	for (uint8 EventIndex{ 0 }; EventIndex < static_cast<uint8>(EEquipmentFragmentEvent::MAX); ++EventIndex)
+	{
+		const auto* Function{ GetClass()->FindFunctionByName(EventFuncNames[EventIndex]) };
+
+		if (Function && Function->GetOuter() && Function->GetOuter()->IsA<UBlueprintGeneratedClass>())
+		{
+			BlueprintEvents |= GetEquipmentFragmentEventBit(static_cast<EEquipmentFragmentEvent>(EventIndex));
+		}
+	}
+
+	BlueprintImplementedEvents = BlueprintEvents;
+	ImplementedEvents = NativeEvents | BlueprintEvents;
+	bImplementedEventsResolved = true;
+}
+
+const UEquipmentFragment* UEquipmentFragment::GetResolvedDefaultObject() const
+{
+	const auto* CDO{ GetClass()->GetDefaultObject<UEquipmentFragment>() };
+
+	if (!CDO->bImplementedEventsResolved)
+	{
+		CDO->ResolveImplementedEvents();
+	}
+
+	return CDO;
+}
+
+bool UEquipmentFragment::ImplementsEvent(EEquipmentFragmentEvent Event) const
+{
+	return (GetResolvedDefaultObject()->ImplementedEvents & GetEquipmentFragmentEventBit(Event)) != 0;
+}
+
+bool UEquipmentFragment::ImplementsBlueprintEvent(EEquipmentFragmentEvent Event) const
+{
+	return (GetResolvedDefaultObject()->BlueprintImplementedEvents & GetEquipmentFragmentEventBit(Event)) != 0;
+}
+
+
 void UEquipmentFragment::HandleEquipmentGiven()
 {
-	UE_LOG(LogGameCore_Equipment, Log, TEXT("| Given: %s"), *GetNameSafe(this));
+	UE_LOG(LogGameCore_Equipment, Verbose, TEXT("| Given: %s"), *GetNameSafe(this));
 
-	OnEquipmentGiven();
+	if (ImplementsBlueprintEvent(EEquipmentFragmentEvent::Given))
+	{
+		OnEquipmentGiven();
+	}
 }
 
 void UEquipmentFragment::HandleEquipmentRemove()
 {
-	UE_LOG(LogGameCore_Equipment, Log, TEXT("| Remove: %s"), *GetNameSafe(this));
+	UE_LOG(LogGameCore_Equipment, Verbose, TEXT("| Remove: %s"), *GetNameSafe(this));
 
-	OnEquipmentRemove();
+	if (ImplementsBlueprintEvent(EEquipmentFragmentEvent::Remove))
+	{
+		OnEquipmentRemove();
+	}
 }
 
 void UEquipmentFragment::HandleEquiped()
 {
-	UE_LOG(LogGameCore_Equipment, Log, TEXT("| Equiped: %s"), *GetNameSafe(this));
+	UE_LOG(LogGameCore_Equipment, Verbose, TEXT("| Equiped: %s"), *GetNameSafe(this));
 
-	OnEquiped();
+	if (ImplementsBlueprintEvent(EEquipmentFragmentEvent::Equiped))
+	{
+		OnEquiped();
+	}
 }
 
 void UEquipmentFragment::HandleUnequiped()
 {
-	UE_LOG(LogGameCore_Equipment, Log, TEXT("| Unequiped: %s"), *GetNameSafe(this));
+	UE_LOG(LogGameCore_Equipment, Verbose, TEXT("| Unequiped: %s"), *GetNameSafe(this));
 
-	OnUnequiped();
+	if (ImplementsBlueprintEvent(EEquipmentFragmentEvent::Unequiped))
+	{
+		OnUnequiped();
+	}
 }
 
 
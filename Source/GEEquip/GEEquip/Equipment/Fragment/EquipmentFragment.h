@@ -30,6 +30,57 @@ public:
 	EEquipmentFragmentNetExecutionPolicy GetNetExecutionPolicy() const { return NetExecutionPolicy; }
 
 
+	/////////////////////////////////////////////////////////////////////////////////////
+	// Implemented Events
+protected:
+	//
+	// Mask of events overridden natively by this class
+	// 
+	// Tips:
+	//	Native subclasses should narrow this down in the constructor to the events they override.
+	//	All events are assumed to be implemented if it is not set.
+	//
+	uint8 NativeImplementedEvents{ EquipmentFragmentEventMask_All };
+
+private:
+	//
+	// Resolved masks of implemented events (only resolved on the CDO)
+	//
+	mutable uint8 ImplementedEvents{ 0 };
+	mutable uint8 BlueprintImplementedEvents{ 0 };
+	mutable bool bImplementedEventsResolved{ false };
+
+	/**
+	 * Resolve the events implemented natively or in Blueprint by this class
+	 */
+	void ResolveImplementedEvents() const;
+
+	/**
+	 * Returns the CDO of this class with the implemented events resolved
+	 */
+	const UEquipmentFragment* GetResolvedDefaultObject() const;
+
+public:
+	/**
+	 * Returns whether this class implements the event either natively or in Blueprint
+	 */
+	bool ImplementsEvent(EEquipmentFragmentEvent Event) const;
+
+	/**
+	 * Returns whether this class implements the event in Blueprint
+	 */
+	bool ImplementsBlueprintEvent(EEquipmentFragmentEvent Event) const;
+
+
+	/////////////////////////////////////////////////////////////////////////////////////
+	// Assets
+public:
+	/**
+	 * Add the soft referenced assets used by this fragment so that they can be loaded together with the equipment
+	 */
+	virtual void GetAssetsToLoad(TArray<FSoftObjectPath>& OutPaths) const {}
+
+
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Event
 public:
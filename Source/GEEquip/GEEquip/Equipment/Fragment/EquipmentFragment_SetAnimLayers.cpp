@@ -18,6 +18,7 @@ UEquipmentFragment_SetAnimLayers::UEquipmentFragment_SetAnimLayers(const FObject
 	: Super(ObjectInitializer)
 {
 	NetExecutionPolicy = EEquipmentFragmentNetExecutionPolicy::Both;
+	NativeImplementedEvents = GetEquipmentFragmentEventBit(EEquipmentFragmentEvent::Equiped) | GetEquipmentFragmentEventBit(EEquipmentFragmentEvent::Unequiped);
 
 #if WITH_EDITOR
 	StaticClass()->FindPropertyByName(FName{ TEXTVIEW("NetExecutionPolicy") })->SetPropertyFlags(CPF_DisableEditOnTemplate);
@@ -15,6 +15,7 @@ UEquipmentFragment_SetTagStats::UEquipmentFragment_SetTagStats(const FObjectInit
 	: Super(ObjectInitializer)
 {
 	NetExecutionPolicy = EEquipmentFragmentNetExecutionPolicy::ServerOnly;
+	NativeImplementedEvents = GetEquipmentFragmentEventBit(EEquipmentFragmentEvent::Given);
 
 #if WITH_EDITOR
 	StaticClass()->FindPropertyByName(FName{ TEXTVIEW("NetExecutionPolicy") })->SetPropertyFlags(CPF_DisableEditOnTemplate);
@@ -2,9 +2,13 @@
 
 #include "EquipmentFragment_SpawnMeshes.h"
 
+#include "Subsystem/EquipmentMeshPoolSubsystem.h"
+
 #include "Character/CharacterMeshAccessorInterface.h"
 
 #include "Components/SkeletalMeshComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 
 #if WITH_EDITOR
 #include "Misc/DataValidation.h"
@@ -27,7 +31,35 @@ bool FMeshComponentToAddEquipment::IsValid() const
 
 bool FEquipmentMeshToSpawn::IsValid() const
 {
-	return ::IsValid(MeshToSpawn);
+	return !MeshToSpawn.IsNull();
+}
+
+bool FEquipmentMeshToSpawn::IsLoaded() const
+{
+	if (!MeshToSpawn.Get())
+	{
+		return false;
+	}
+
+	if ((AnimationMode == EEquipmentMeshAnimationMode::AnimInstance) && !MeshAnimInstance.IsNull() && !MeshAnimInstance.Get())
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void FEquipmentMeshToSpawn::GetAssetsToStream(TArray<FSoftObjectPath>& OutPaths) const
+{
+	if (!MeshToSpawn.IsNull() && !MeshToSpawn.Get())
+	{
+		OutPaths.AddUnique(MeshToSpawn.ToSoftObjectPath());
+	}
+
+	if ((AnimationMode == EEquipmentMeshAnimationMode::AnimInstance) && !MeshAnimInstance.IsNull() && !MeshAnimInstance.Get())
+	{
+		OutPaths.AddUnique(MeshAnimInstance.ToSoftObjectPath());
+	}
 }
 
 
@@ -38,6 +70,7 @@ UEquipmentFragment_SpawnMeshes::UEquipmentFragment_SpawnMeshes(const FObjectInit
 	: Super(ObjectInitializer)
 {
 	NetExecutionPolicy = EEquipmentFragmentNetExecutionPolicy::ClientOnly;
+	NativeImplementedEvents = GetEquipmentFragmentEventBit(EEquipmentFragmentEvent::Remove) | GetEquipmentFragmentEventBit(EEquipmentFragmentEvent::Equiped) | GetEquipmentFragmentEventBit(EEquipmentFragmentEvent::Unequiped);
 
 #if WITH_EDITOR
 	StaticClass()->FindPropertyByName(FName{ TEXTVIEW("NetExecutionPolicy") })->SetPropertyFlags(CPF_DisableEditOnTemplate);
@@ -80,65 +113,311 @@ EDataValidationResult UEquipmentFragment_SpawnMeshes::IsDataValid(FDataValidatio
 #endif
 
 
+void UEquipmentFragment_SpawnMeshes::GetAssetsToLoad(TArray<FSoftObjectPath>& OutPaths) const
+{
+	Super::GetAssetsToLoad(OutPaths);
+
+	for (const auto& SpawnInfo : MeshesToSpawn)
+	{
+		if (!SpawnInfo.MeshToSpawn.IsNull())
+		{
+			OutPaths.AddUnique(SpawnInfo.MeshToSpawn.ToSoftObjectPath());
+		}
+
+		if ((SpawnInfo.AnimationMode == EEquipmentMeshAnimationMode::AnimInstance) && !SpawnInfo.MeshAnimInstance.IsNull())
+		{
+			OutPaths.AddUnique(SpawnInfo.MeshAnimInstance.ToSoftObjectPath());
+		}
+	}
+}
+
+
+void UEquipmentFragment_SpawnMeshes::HandleEquipmentRemove()
+{
+	Super::HandleEquipmentRemove();
+
+	DestroySpawnedMeshes();
+}
+
 void UEquipmentFragment_SpawnMeshes::HandleEquiped()
 {
 	Super::HandleEquiped();
 
-	if (auto* Owner{ GetEquipmentOwner() })
+	// Only show the meshes if they are kept from the last unequip
+
+	if (!SpawnedMeshes.IsEmpty())
+	{
+		ShowSpawnedMeshes();
+	}
+	else if (auto* Owner{ GetEquipmentOwner() })
+	{
+		SpawnMeshes(Owner);
+	}
+}
+
+void UEquipmentFragment_SpawnMeshes::HandleUnequiped()
+{
+	Super::HandleUnequiped();
+
+	switch (UnequipBehavior)
+	{
+	case EEquipmentMeshUnequipBehavior::Hide:
+		HideSpawnedMeshes();
+		break;
+
+	case EEquipmentMeshUnequipBehavior::Holster:
+		HolsterSpawnedMeshes();
+		break;
+
+	default:
+		DestroySpawnedMeshes();
+		break;
+	}
+}
+
+
+void UEquipmentFragment_SpawnMeshes::SpawnMeshes(AActor* Owner)
+{
+	const auto bLocallyControlled{ Owner->HasLocalNetOwner() };
+
+	for (const auto& Entry : ComponentToAdd)
 	{
-		const auto bLocallyControlled{ Owner->HasLocalNetOwner() };
+		const auto bCanAdd
+		{
+			(bLocallyControlled && Entry.bAddToOwner) || (!bLocallyControlled && Entry.bAddToOther)
+		};
 
-		for (const auto& Entry : ComponentToAdd)
+		if (bCanAdd)
 		{
-			const auto bCanAdd
+			if (auto* Mesh{ ICharacterMeshAccessorInterface::Execute_GetMeshByTag(Owner, Entry.MeshTypeTag) })
 			{
-				(bLocallyControlled && Entry.bAddToOwner) || (!bLocallyControlled && Entry.bAddToOther)
-			};
+				const auto bOwnerNoSee{ static_cast<bool>(Mesh->bOwnerNoSee) };
+				const auto bOnlyOwnerSee{ static_cast<bool>(Mesh->bOnlyOwnerSee) };
+				const auto bHiddenInGame{ static_cast<bool>(Mesh->bHiddenInGame) };
+				const auto bCastShadow{ static_cast<bool>(Mesh->CastShadow) };
 
-			if (bCanAdd)
-			{
-				if (auto* Mesh{ ICharacterMeshAccessorInterface::Execute_GetMeshByTag(Owner, Entry.MeshTypeTag) })
+				for (auto It{ MeshesToSpawn.CreateConstIterator() }; It; ++It)
 				{
-					const auto bOwnerNoSee{ static_cast<bool>(Mesh->bOwnerNoSee) };
-					const auto bOnlyOwnerSee{ static_cast<bool>(Mesh->bOnlyOwnerSee) };
-					const auto bHiddenInGame{ static_cast<bool>(Mesh->bHiddenInGame) };
-					const auto bCastShadow{ static_cast<bool>(Mesh->CastShadow) };
+					const auto& SpawnInfo{ *It };
 
-					for (const auto& SpawnInfo : MeshesToSpawn)
+					if (SpawnInfo.IsValid())
 					{
-						if (SpawnInfo.MeshToSpawn)
-						{
-							USkeletalMeshComponent* NewMesh = NewObject<USkeletalMeshComponent>(Owner);
-							NewMesh->SetSkeletalMesh(SpawnInfo.MeshToSpawn);
-							NewMesh->SetAnimInstanceClass(SpawnInfo.MeshAnimInstance);
-							NewMesh->SetRelativeTransform(SpawnInfo.AttachTransform);
-							NewMesh->AttachToComponent(Mesh, FAttachmentTransformRules::KeepRelativeTransform, SpawnInfo.AttachSocket);
-							NewMesh->SetOwnerNoSee(bOwnerNoSee);
-							NewMesh->SetOnlyOwnerSee(bOnlyOwnerSee);
-							NewMesh->SetHiddenInGame(bHiddenInGame);
-							NewMesh->SetCastShadow(bCastShadow);
-							NewMesh->RegisterComponent();
-
-							SpawnedMeshes.Add(NewMesh);
-						}
+						auto* NewMesh{ AcquireMeshComponent(Owner) };
+
+						ApplyMeshToSpawn(NewMesh, Mesh, SpawnInfo);
+
+						NewMesh->SetRelativeTransform(SpawnInfo.AttachTransform);
+						NewMesh->AttachToComponent(Mesh, FAttachmentTransformRules::KeepRelativeTransform, SpawnInfo.AttachSocket);
+						NewMesh->SetOwnerNoSee(bOwnerNoSee);
+						NewMesh->SetOnlyOwnerSee(bOnlyOwnerSee);
+						NewMesh->SetHiddenInGame(bHiddenInGame);
+						NewMesh->SetCastShadow(bCastShadow);
+						NewMesh->SetComponentTickEnabled(true);
+						NewMesh->bPauseAnims = false;
+
+						auto& NewEntry{ SpawnedMeshes.AddDefaulted_GetRef() };
+						NewEntry.Component = NewMesh;
+						NewEntry.Parent = Mesh;
+						NewEntry.SpawnInfoIndex = It.GetIndex();
 					}
 				}
 			}
 		}
 	}
+
+	StreamMeshes();
 }
 
-void UEquipmentFragment_SpawnMeshes::HandleUnequiped()
+void UEquipmentFragment_SpawnMeshes::ShowSpawnedMeshes()
 {
-	Super::HandleUnequiped();
+	for (const auto& Entry : SpawnedMeshes)
+	{
+		auto* Mesh{ Entry.Component.Get() };
+		auto* Parent{ Entry.Parent.Get() };
+
+		if (Mesh && Parent && MeshesToSpawn.IsValidIndex(Entry.SpawnInfoIndex))
+		{
+			const auto& SpawnInfo{ MeshesToSpawn[Entry.SpawnInfoIndex] };
+
+			// Attach back from holster socket
+
+			if ((UnequipBehavior == EEquipmentMeshUnequipBehavior::Holster) && !SpawnInfo.HolsterSocket.IsNone())
+			{
+				Mesh->SetRelativeTransform(SpawnInfo.AttachTransform);
+				Mesh->AttachToComponent(Parent, FAttachmentTransformRules::KeepRelativeTransform, SpawnInfo.AttachSocket);
+			}
+
+			Mesh->SetHiddenInGame(Parent->bHiddenInGame);
+			Mesh->SetComponentTickEnabled(true);
+			Mesh->bPauseAnims = false;
+		}
+	}
+}
+
+void UEquipmentFragment_SpawnMeshes::HideSpawnedMeshes()
+{
+	for (const auto& Entry : SpawnedMeshes)
+	{
+		if (auto* Mesh{ Entry.Component.Get() })
+		{
+			Mesh->SetHiddenInGame(true);
+			Mesh->SetComponentTickEnabled(false);
+			Mesh->bPauseAnims = true;
+		}
+	}
+}
 
-	for (const auto& Mesh : SpawnedMeshes)
+void UEquipmentFragment_SpawnMeshes::HolsterSpawnedMeshes()
+{
+	for (const auto& Entry : SpawnedMeshes)
+	{
+		auto* Mesh{ Entry.Component.Get() };
+		auto* Parent{ Entry.Parent.Get() };
+
+		if (Mesh && Parent && MeshesToSpawn.IsValidIndex(Entry.SpawnInfoIndex))
+		{
+			const auto& SpawnInfo{ MeshesToSpawn[Entry.SpawnInfoIndex] };
+
+			// Hide it if there is no socket to holster
+
+			if (SpawnInfo.HolsterSocket.IsNone())
+			{
+				Mesh->SetHiddenInGame(true);
+				Mesh->SetComponentTickEnabled(false);
+				Mesh->bPauseAnims = true;
+			}
+			else
+			{
+				Mesh->SetRelativeTransform(SpawnInfo.HolsterTransform);
+				Mesh->AttachToComponent(Parent, FAttachmentTransformRules::KeepRelativeTransform, SpawnInfo.HolsterSocket);
+			}
+		}
+	}
+}
+
+void UEquipmentFragment_SpawnMeshes::DestroySpawnedMeshes()
+{
+	CancelStreamingMeshes();
+
+	for (const auto& Entry : SpawnedMeshes)
 	{
-		if (Mesh)
+		if (auto* Mesh{ Entry.Component.Get() })
 		{
-			Mesh->DestroyComponent();
+			ReleaseMeshComponent(Mesh);
 		}
 	}
 
 	SpawnedMeshes.Empty();
 }
+
+
+void UEquipmentFragment_SpawnMeshes::StreamMeshes()
+{
+	if (MeshStreamingHandle.IsValid())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> AssetsToStream;
+
+	for (const auto& SpawnInfo : MeshesToSpawn)
+	{
+		SpawnInfo.GetAssetsToStream(AssetsToStream);
+	}
+
+	if (!AssetsToStream.IsEmpty())
+	{
+		MeshStreamingHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			AssetsToStream, FStreamableDelegate::CreateUObject(this, &ThisClass::HandleMeshesStreamed));
+	}
+}
+
+void UEquipmentFragment_SpawnMeshes::HandleMeshesStreamed()
+{
+	// Replace placeholders of the meshes that are still spawned
+
+	for (const auto& Entry : SpawnedMeshes)
+	{
+		auto* Mesh{ Entry.Component.Get() };
+		auto* Parent{ Entry.Parent.Get() };
+
+		if (Mesh && Parent && MeshesToSpawn.IsValidIndex(Entry.SpawnInfoIndex))
+		{
+			ApplyMeshToSpawn(Mesh, Parent, MeshesToSpawn[Entry.SpawnInfoIndex]);
+		}
+	}
+}
+
+void UEquipmentFragment_SpawnMeshes::CancelStreamingMeshes()
+{
+	// Cancel if it is still loading, otherwise release the meshes so that they can be unloaded
+
+	if (MeshStreamingHandle.IsValid())
+	{
+		if (MeshStreamingHandle->IsLoadingInProgress())
+		{
+			MeshStreamingHandle->CancelHandle();
+		}
+		else
+		{
+			MeshStreamingHandle->ReleaseHandle();
+		}
+
+		MeshStreamingHandle.Reset();
+	}
+}
+
+void UEquipmentFragment_SpawnMeshes::ApplyMeshToSpawn(USkeletalMeshComponent* Component, USkeletalMeshComponent* Parent, const FEquipmentMeshToSpawn& SpawnInfo) const
+{
+	// Use placeholder until the mesh and anim instance are streamed in
+
+	const auto bLoaded{ SpawnInfo.IsLoaded() };
+
+	Component->SetSkeletalMesh(bLoaded ? SpawnInfo.MeshToSpawn.Get() : SpawnInfo.PlaceholderMesh.Get());
+
+	// Follow the parent pose instead of evaluating own animation
+
+	if (SpawnInfo.AnimationMode == EEquipmentMeshAnimationMode::LeaderPose)
+	{
+		Component->SetAnimInstanceClass(nullptr);
+		Component->SetLeaderPoseComponent(Parent);
+		Component->bUseBoundsFromLeaderPoseComponent = true;
+	}
+	else
+	{
+		Component->SetLeaderPoseComponent(nullptr);
+		Component->bUseBoundsFromLeaderPoseComponent = false;
+		Component->SetAnimInstanceClass(bLoaded ? SpawnInfo.MeshAnimInstance.Get() : nullptr);
+	}
+}
+
+
+USkeletalMeshComponent* UEquipmentFragment_SpawnMeshes::AcquireMeshComponent(AActor* Owner) const
+{
+	if (bUseMeshPool)
+	{
+		if (auto* Pool{ UEquipmentMeshPoolSubsystem::Get(Owner) })
+		{
+			return Pool->AcquireMeshComponent(Owner);
+		}
+	}
+
+	auto* NewMesh{ NewObject<USkeletalMeshComponent>(Owner) };
+	NewMesh->RegisterComponent();
+
+	return NewMesh;
+}
+
+void UEquipmentFragment_SpawnMeshes::ReleaseMeshComponent(USkeletalMeshComponent* Component) const
+{
+	if (bUseMeshPool)
+	{
+		if (auto* Pool{ UEquipmentMeshPoolSubsystem::Get(Component) })
+		{
+			Pool->ReleaseMeshComponent(Component);
+			return;
+		}
+	}
+
+	Component->DestroyComponent();
+}
@@ -11,6 +11,47 @@
 class USkeletalMeshComponent;
 class USkeletalMesh;
 class UAnimInstance;
+struct FStreamableHandle;
+
+
+/**
+ * How the spawned mesh is animated
+ */
+UENUM(BlueprintType)
+enum class EEquipmentMeshAnimationMode : uint8
+{
+	// Evaluate animation with its own MeshAnimInstance
+	// 
+	// Tips:
+	//	Use an AnimInstance with a Copy Pose From Mesh node to copy the pose of the parent mesh
+	AnimInstance,
+
+	// Follow the pose of the parent mesh as a leader pose follower without evaluating animation
+	// 
+	// Tips:
+	//	The mesh must share the skeleton of the parent mesh, e.g. armor and clothing
+	LeaderPose
+};
+
+
+/**
+ * What to do with the spawned meshes when the equipment is unequipped
+ */
+UENUM(BlueprintType)
+enum class EEquipmentMeshUnequipBehavior : uint8
+{
+	// Destroy the spawned meshes (or return them to the pool)
+	Destroy,
+
+	// Keep the spawned meshes hidden with animation paused until equipped again
+	Hide,
+
+	// Keep the spawned meshes visible and attach them to the holster socket
+	// 
+	// Tips:
+	//	The meshes are hidden instead if HolsterSocket is not set
+	Holster
+};
 
 
 /**
@@ -51,10 +92,19 @@ public:
 
 public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	TObjectPtr<USkeletalMesh> MeshToSpawn;
+	TSoftObjectPtr<USkeletalMesh> MeshToSpawn;
+
+	//
+	// Low-cost mesh shown while MeshToSpawn is streaming in
+	//
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay)
+	TObjectPtr<USkeletalMesh> PlaceholderMesh;
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	TSubclassOf<UAnimInstance> MeshAnimInstance;
+	EEquipmentMeshAnimationMode AnimationMode{ EEquipmentMeshAnimationMode::AnimInstance };
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "AnimationMode == EEquipmentMeshAnimationMode::AnimInstance"))
+	TSoftClassPtr<UAnimInstance> MeshAnimInstance;
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	FName AttachSocket;
@@ -62,9 +112,48 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	FTransform AttachTransform;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FName HolsterSocket;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FTransform HolsterTransform;
+
 public:
 	bool IsValid() const;
 
+	/**
+	 * Returns whether the mesh and anim instance needed to spawn are already loaded
+	 */
+	bool IsLoaded() const;
+
+	/**
+	 * Add the assets that are not loaded yet to the list
+	 */
+	void GetAssetsToStream(TArray<FSoftObjectPath>& OutPaths) const;
+
+};
+
+
+/**
+ * Data of the mesh spawned by the fragment
+ */
+USTRUCT()
+struct FEquipmentSpawnedMesh
+{
+	GENERATED_BODY()
+public:
+	FEquipmentSpawnedMesh() {}
+
+public:
+	UPROPERTY()
+	TObjectPtr<USkeletalMeshComponent> Component{ nullptr };
+
+	UPROPERTY()
+	TWeakObjectPtr<USkeletalMeshComponent> Parent{ nullptr };
+
+	UPROPERTY()
+	int32 SpawnInfoIndex{ INDEX_NONE };
+
 };
 
 
@@ -95,12 +184,53 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "SpawnMeshes")
 	TArray<FMeshComponentToAddEquipment> ComponentToAdd;
 
+	//
+	// Whether to check out spawned meshes from the pool of the owner instead of creating and destroying them each time
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "SpawnMeshes")
+	bool bUseMeshPool{ true };
+
+	//
+	// What to do with the spawned meshes when unequipped
+	// 
+	// Tips:
+	//	If it is not Destroy, the spawned meshes are kept until the equipment is removed,
+	//	and equipping again only toggles visibility and attachment.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "SpawnMeshes")
+	EEquipmentMeshUnequipBehavior UnequipBehavior{ EEquipmentMeshUnequipBehavior::Destroy };
+
 protected:
 	UPROPERTY(Transient)
-	TArray<TObjectPtr<USkeletalMeshComponent>> SpawnedMeshes;
+	TArray<FEquipmentSpawnedMesh> SpawnedMeshes;
+
+	//
+	// Handle that streams in and keeps the meshes to spawn resident while they are spawned
+	//
+	TSharedPtr<FStreamableHandle> MeshStreamingHandle;
 
 public:
+	virtual void GetAssetsToLoad(TArray<FSoftObjectPath>& OutPaths) const override;
+
+public:
+	virtual void HandleEquipmentRemove() override;
 	virtual void HandleEquiped() override;
 	virtual void HandleUnequiped() override;
 
+protected:
+	void SpawnMeshes(AActor* Owner);
+	void ShowSpawnedMeshes();
+	void HideSpawnedMeshes();
+	void HolsterSpawnedMeshes();
+	void DestroySpawnedMeshes();
+
+	void StreamMeshes();
+	void HandleMeshesStreamed();
+	void CancelStreamingMeshes();
+
+	void ApplyMeshToSpawn(USkeletalMeshComponent* Component, USkeletalMeshComponent* Parent, const FEquipmentMeshToSpawn& SpawnInfo) const;
+
+	USkeletalMeshComponent* AcquireMeshComponent(AActor* Owner) const;
+	void ReleaseMeshComponent(USkeletalMeshComponent* Component) const;
+
 };
@@ -0,0 +1,136 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "EquipmentCatalog.h"
+
+#include "Equipment/Equipment.h"
+#include "GEEquipLogs.h"
+
+#include "ItemData.h"
+
+#if WITH_EDITOR
+#include "Development/GEEquipDeveloperSettings.h"
+
+#include "Engine/AssetManager.h"
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentCatalog)
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// FEquipmentCatalogEntry
+
+bool FEquipmentCatalogEntry::CanAddToSlot(const FGameplayTag& SlotTag) const
+{
+	return !AddableSlots.IsValid() || AddableSlotMask.HasSlot(AddableSlots, SlotTag);
+}
+
+TSubclassOf<UEquipment> FEquipmentCatalogEntry::GetEquipmentClass() const
+{
+	return UItemInfo_Equipment::ResolveSoftEquipmentClass(EquipmentClass);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// UEquipmentCatalog
+
+UEquipmentCatalog::UEquipmentCatalog(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+
+void UEquipmentCatalog::PostLoad()
+{
+	Super::PostLoad();
+
+	RebuildIndices();
+}
+
+#if WITH_EDITOR
+void UEquipmentCatalog::PreSave(FObjectPreSaveContext SaveContext)
+{
+	if (SaveContext.IsCooking())
+	{
+		BakeEntries();
+	}
+
+	Super::PreSave(SaveContext);
+}
+#endif
+
+
+void UEquipmentCatalog::RebuildIndices()
+{
+	ItemDataToIndex.Reset();
+	ItemDataToIndex.Reserve(Entries.Num());
+
+	for (auto It{ Entries.CreateConstIterator() }; It; ++It)
+	{
+		ItemDataToIndex.Add(It->ItemData.GetAssetPath(), It.GetIndex());
+
+		It->AddableSlotMask.Update(It->AddableSlots);
+	}
+}
+
+const FEquipmentCatalogEntry* UEquipmentCatalog::FindEntry(const UItemData* ItemData) const
+{
+	if (!ItemData)
+	{
+		return nullptr;
+	}
+
+	const auto* Index{ ItemDataToIndex.Find(FTopLevelAssetPath(ItemData)) };
+
+	return Index ? &Entries[*Index] : nullptr;
+}
+
+
+#if WITH_EDITOR
+void UEquipmentCatalog::RebuildCatalog()
+{
+	Modify();
+
+	BakeEntries();
+}
+
+void UEquipmentCatalog::BakeEntries()
+{
+	auto& AssetManager{ UAssetManager::Get() };
+
+	Entries.Reset();
+
+	for (const auto& AssetType : GetDefault<UGEEquipDeveloperSettings>()->ItemAssetTypes)
+	{
+		TArray<FSoftObjectPath> AssetPaths;
+		AssetManager.GetPrimaryAssetPathList(AssetType, AssetPaths);
+
+		for (const auto& AssetPath : AssetPaths)
+		{
+			const auto* ItemData{ Cast<UItemData>(AssetPath.TryLoad()) };
+			const auto* EquipmentInfo{ ItemData ? ItemData->FindInfo<UItemInfo_Equipment>() : nullptr };
+
+			// Only bake items whose Equipment class does not depend on custom info
+
+			if (!EquipmentInfo || (EquipmentInfo->GetClass() != UItemInfo_Equipment::StaticClass()))
+			{
+				continue;
+			}
+
+			auto& NewEntry{ Entries.AddDefaulted_GetRef() };
+			NewEntry.ItemData = FSoftObjectPath(ItemData);
+			NewEntry.AddableSlots = EquipmentInfo->GetAddableSlots();
+			NewEntry.SlotRules = EquipmentInfo->GetSlotRules();
+			NewEntry.EquipmentClass = EquipmentInfo->GetSoftEquipmentClass();
+		}
+	}
+
+	// Sort for deterministic cooking
+
+	Entries.Sort([](const FEquipmentCatalogEntry& A, const FEquipmentCatalogEntry& B) { return A.ItemData.LexicalLess(B.ItemData); });
+
+	RebuildIndices();
+
+	UE_LOG(LogGameCore_Equipment, Log, TEXT("Rebuilt equipment catalog [%s] with %d entries"), *GetNameSafe(this), Entries.Num());
+}
+#endif
@@ -0,0 +1,121 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+
+#include "Item/ItemInfo_Equipment.h"
+
+#include "GameplayTagContainer.h"
+
+#include "EquipmentCatalog.generated.h"
+
+class UItemData;
+class UEquipment;
+
+
+/**
+ * Flattened data of an equipment item baked into the catalog
+ */
+USTRUCT()
+struct GEEQUIP_API FEquipmentCatalogEntry
+{
+	GENERATED_BODY()
+public:
+	FEquipmentCatalogEntry() {}
+
+public:
+	UPROPERTY(VisibleAnywhere)
+	FSoftObjectPath ItemData;
+
+	UPROPERTY(VisibleAnywhere)
+	FGameplayTagContainer AddableSlots;
+
+	//
+	// Bit set of AddableSlots and their parents by slot index built at runtime
+	//
+	mutable FEquipmentSlotMaskCache AddableSlotMask;
+
+	UPROPERTY(VisibleAnywhere)
+	FEquipmentSlotRules SlotRules;
+
+	UPROPERTY(VisibleAnywhere)
+	TSoftClassPtr<UEquipment> EquipmentClass;
+
+public:
+	/**
+	 * Returns whether the item can be added to the slot
+	 */
+	bool CanAddToSlot(const FGameplayTag& SlotTag) const;
+
+	/**
+	 * Returns the Equipment class resolved by UItemInfo_Equipment::ResolveSoftEquipmentClass()
+	 */
+	TSubclassOf<UEquipment> GetEquipmentClass() const;
+
+};
+
+
+/**
+ * Immutable table of all equipment items flattened at cook time for constant time lookup at runtime
+ * 
+ * Tips:
+ *	The catalog is rebuilt automatically when cooked and can be rebuilt manually in the editor.
+ *	It is only read in cooked builds, so uncooked builds always resolve from the live equipment infos.
+ *	Items whose equipment info is a custom subclass are not baked because they may resolve the Equipment class dynamically,
+ *	so they are resolved with the virtual functions of the info at runtime.
+ *	Set this asset to EquipmentCatalog in the project settings and make sure it is cooked, e.g. as a primary asset.
+ */
+UCLASS(BlueprintType, Const)
+class GEEQUIP_API UEquipmentCatalog : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+public:
+	UEquipmentCatalog(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+public:
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#endif
+
+protected:
+	//
+	// Baked entries sorted by item data path
+	//
+	UPROPERTY(VisibleAnywhere, Category = "Catalog")
+	TArray<FEquipmentCatalogEntry> Entries;
+
+	//
+	// Index of the entry for each item data asset path
+	// 
+	// Tips:
+	//	Keyed by the top level asset path so that lookups only compare names without building path strings.
+	//
+	TMap<FTopLevelAssetPath, int32> ItemDataToIndex;
+
+protected:
+	void RebuildIndices();
+
+#if WITH_EDITOR
+	void BakeEntries();
+#endif
+
+public:
+	/**
+	 * Returns the baked entry of the item data or nullptr if it is not baked
+	 */
+	const FEquipmentCatalogEntry* FindEntry(const UItemData* ItemData) const;
+
+	const TArray<FEquipmentCatalogEntry>& GetEntries() const { return Entries; }
+
+#if WITH_EDITOR
+	/**
+	 * Scan all item data of the asset types in the settings and rebuild the entries
+	 */
+	UFUNCTION(CallInEditor, Category = "Catalog")
+	void RebuildCatalog();
+#endif
+
+};
@@ -3,6 +3,9 @@
 #include "EquipmentManagerComponent.h"
 
 #include "Equipment/Equipment.h"
+#include "Item/ItemInfo_Equipment.h"
+#include "Type/EquipmentChangeSetTypes.h"
+#include "EquipmentSlotLayout.h"
 #include "GEEquipLogs.h"
 
 #include "ItemData.h"
@@ -12,6 +15,9 @@
 #include "Net/UnrealNetwork.h"
 #include "Net/Core/PushModel/PushModel.h"
 #include "Engine/ActorChannel.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/CoreDelegates.h"
 #include "Components/GameFrameworkComponentManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentManagerComponent)
@@ -32,11 +38,29 @@ UEquipmentManagerComponent::UEquipmentManagerComponent(const FObjectInitializer&
 
 void UEquipmentManagerComponent::OnRegister()
 {
-	ActiveEquipments.RegisterOwner(GetOwner(), this);
+	ActiveEquipments.RegisterOwner(GetOwner(), this, SlotLayout);
+	ActiveEquipments.SetDeferSlotMessagesToEndOfFrame(bCoalesceSlotChangeMessages);
 
 	Super::OnRegister();
 }
 
+void UEquipmentManagerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelAllPendingEquipmentItems();
+
+	// Entries are not removed through the replication callbacks on teardown, so release their assets here
+
+	ActiveEquipments.ReleaseAll();
+
+	if (EndFrameDelegateHandle.IsValid())
+	{
+		FCoreDelegates::OnEndFrame.Remove(EndFrameDelegateHandle);
+		EndFrameDelegateHandle.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void UEquipmentManagerComponent::HandleChangeInitStateToDataInitialized(UGameFrameworkComponentManager* Manager)
 {
 	ActiveEquipments.HandleInitialized();
@@ -85,6 +109,39 @@ void UEquipmentManagerComponent::ReadyForReplication()
 }
 
 
+FDelegateHandle UEquipmentManagerComponent::AddSlotChangeListener(FGameplayTag SlotTag, FEquipmentSlotNativeEventDelegate::FDelegate Delegate, bool bIncludeChildSlots)
+{
+	return SlotChangeListeners.Add(SlotTag, MoveTemp(Delegate), bIncludeChildSlots);
+}
+
+void UEquipmentManagerComponent::RemoveSlotChangeListener(FGameplayTag SlotTag, FDelegateHandle Handle)
+{
+	SlotChangeListeners.Remove(SlotTag, Handle);
+}
+
+void UEquipmentManagerComponent::RemoveAllSlotChangeListeners(const void* UserObject)
+{
+	SlotChangeListeners.RemoveAll(UserObject);
+}
+
+
+void UEquipmentManagerComponent::RequestFlushSlotChangeMessages()
+{
+	if (!EndFrameDelegateHandle.IsValid())
+	{
+		EndFrameDelegateHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &ThisClass::HandleEndFrame);
+	}
+}
+
+void UEquipmentManagerComponent::HandleEndFrame()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameDelegateHandle);
+	EndFrameDelegateHandle.Reset();
+
+	ActiveEquipments.FlushSlotChangeMessages();
+}
+
+
 void UEquipmentManagerComponent::RegisterReplicatedSubobject(UEquipment* Instance)
 {
 	if (IsUsingRegisteredSubObjectList())
@@ -102,7 +159,7 @@ void UEquipmentManagerComponent::UnregisterReplicatedSubobject(UEquipment* Insta
 }
 
 
-bool UEquipmentManagerComponent::AddEquipmentItem(FGameplayTag InSlotTag, const UItemData* InItemData, FActiveEquipmentHandle& OutHandle, bool bEquipImmediately)
+bool UEquipmentManagerComponent::AddEquipmentItem(FGameplayTag InSlotTag, const UItemData* InItemData, FActiveEquipmentHandle& OutHandle, bool bEquipImmediately, FName ResolveContext)
 {
 	// Suspend if has not authority
 
@@ -111,7 +168,9 @@ bool UEquipmentManagerComponent::AddEquipmentItem(FGameplayTag InSlotTag, const
 		return false;
 	}
 
-	return ActiveEquipments.AddEquipmentItem(InSlotTag, InItemData, OutHandle, bEquipImmediately);
+	CancelPendingEquipmentItem(InSlotTag);
+
+	return ActiveEquipments.AddEquipmentItem(InSlotTag, InItemData, OutHandle, bEquipImmediately, ResolveContext);
 }
 
 
@@ -124,6 +183,8 @@ void UEquipmentManagerComponent::RemoveEquipmentItemByTag(FGameplayTag SlotTag)
 		return;
 	}
 
+	CancelPendingEquipmentItem(SlotTag);
+
 	ActiveEquipments.RemoveEquipmentItem(SlotTag);
 }
 
@@ -160,6 +221,8 @@ void UEquipmentManagerComponent::RemoveAllEquipmentItem()
 		return;
 	}
 
+	CancelAllPendingEquipmentItems();
+
 	ActiveEquipments.RemoveAllEquipmentItem();
 }
 
@@ -214,16 +277,208 @@ void UEquipmentManagerComponent::UnequipEquipmentByHandle(FActiveEquipmentHandle
 }
 
 
+void UEquipmentManagerComponent::CommitChangeSet(const FEquipmentChangeSet& ChangeSet, TArray<FActiveEquipmentHandle>& OutAddedHandles)
+{
+	// Suspend if has not authority
+
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	CancelPendingEquipmentItems(ChangeSet);
+
+	ActiveEquipments.ApplyChangeSet(ChangeSet, OutAddedHandles);
+}
+
+
+bool UEquipmentManagerComponent::AddEquipmentItemAsync(FGameplayTag InSlotTag, const UItemData* InItemData, FEquipmentItemAddedDelegate OnAdded, bool bEquipImmediately, FName ResolveContext)
+{
+	// Suspend if has not authority
+
+	if (!HasAuthority())
+	{
+		return false;
+	}
+
+	// Suspend if the item cannot be added to the slot
+
+	if (!ActiveEquipments.FindEquipmentInfo(InSlotTag, InItemData))
+	{
+		return false;
+	}
+
+	// Resolve the class once so that the streamed class is the one to be added
+
+	const auto SoftEquipmentClass{ ActiveEquipments.ResolveSoftEquipmentClass(InSlotTag, InItemData, ResolveContext) };
+
+	if (SoftEquipmentClass.IsNull())
+	{
+		UE_LOG(LogGameCore_Equipment, Error, TEXT("EquipmentClass has not set in [%s]"), *GetNameSafe(InItemData));
+		return false;
+	}
+
+	// Replace the item still loading in the slot
+
+	CancelPendingEquipmentItem(InSlotTag);
+
+	// Add immediately if the class is already loaded
+
+	if (const auto EquipmentClass{ SoftEquipmentClass.Get() })
+	{
+		FActiveEquipmentHandle NewHandle;
+		const auto bSucceeded{ ActiveEquipments.AddEquipmentItem(InSlotTag, InItemData, NewHandle, bEquipImmediately, ResolveContext, EquipmentClass) };
+
+		OnAdded.ExecuteIfBound(bSucceeded, NewHandle);
+
+		return bSucceeded;
+	}
+
+	// Reserve the slot and stream the class in
+
+	const auto RequestId{ ++LastPendingRequestId };
+
+	auto& NewPending{ PendingEquipmentItems.Add(InSlotTag) };
+	NewPending.RequestId = RequestId;
+	NewPending.ItemData = InItemData;
+	NewPending.bEquipImmediately = bEquipImmediately;
+	NewPending.ResolveContext = ResolveContext;
+	NewPending.EquipmentClass = SoftEquipmentClass;
+	NewPending.OnAdded = MoveTemp(OnAdded);
+
+	auto StreamingHandle
+	{
+		UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			SoftEquipmentClass.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &ThisClass::HandleEquipmentClassLoaded, InSlotTag, RequestId))
+	};
+
+	// Completion may have already been handled during the request
+
+	if (auto* Pending{ PendingEquipmentItems.Find(InSlotTag) }; Pending && (Pending->RequestId == RequestId))
+	{
+		Pending->StreamingHandle = MoveTemp(StreamingHandle);
+	}
+
+	return true;
+}
+
+bool UEquipmentManagerComponent::K2_AddEquipmentItemAsync(FGameplayTag InSlotTag, const UItemData* InItemData, FEquipmentItemAddedDynamicDelegate OnAdded, bool bEquipImmediately, FName ResolveContext)
+{
+	return AddEquipmentItemAsync(InSlotTag, InItemData, FEquipmentItemAddedDelegate::CreateLambda(
+		[OnAdded](bool bSucceeded, FActiveEquipmentHandle Handle)
+		{
+			OnAdded.ExecuteIfBound(bSucceeded, Handle);
+		}
+	), bEquipImmediately, ResolveContext);
+}
+
+bool UEquipmentManagerComponent::CancelPendingEquipmentItem(FGameplayTag SlotTag)
+{
+	FPendingEquipmentItem Pending;
+
+	if (!PendingEquipmentItems.RemoveAndCopyValue(SlotTag, Pending))
+	{
+		return false;
+	}
+
+	if (Pending.StreamingHandle.IsValid())
+	{
+		Pending.StreamingHandle->CancelHandle();
+	}
+
+	Pending.OnAdded.ExecuteIfBound(false, FActiveEquipmentHandle());
+
+	return true;
+}
+
+void UEquipmentManagerComponent::HandleEquipmentClassLoaded(FGameplayTag SlotTag, uint32 RequestId)
+{
+	// Ignore if the request was replaced or cancelled
+
+	const auto* Pending{ PendingEquipmentItems.Find(SlotTag) };
+
+	if (!Pending || (Pending->RequestId != RequestId))
+	{
+		return;
+	}
+
+	FPendingEquipmentItem Completed;
+	PendingEquipmentItems.RemoveAndCopyValue(SlotTag, Completed);
+
+	// Add it with the loaded class without resolving it again
+
+	const auto EquipmentClass{ Completed.EquipmentClass.Get() };
+
+	UE_CLOG(!EquipmentClass, LogGameCore_Equipment, Error, TEXT("Failed to load EquipmentClass [%s]"), *Completed.EquipmentClass.ToString());
+
+	FActiveEquipmentHandle NewHandle;
+	const auto bSucceeded{ EquipmentClass && ActiveEquipments.AddEquipmentItem(SlotTag, Completed.ItemData.Get(), NewHandle, Completed.bEquipImmediately, Completed.ResolveContext, EquipmentClass) };
+
+	Completed.OnAdded.ExecuteIfBound(bSucceeded, NewHandle);
+}
+
+void UEquipmentManagerComponent::CancelAllPendingEquipmentItems()
+{
+	TArray<FGameplayTag> PendingSlots;
+	PendingEquipmentItems.GetKeys(PendingSlots);
+
+	for (const auto& SlotTag : PendingSlots)
+	{
+		CancelPendingEquipmentItem(SlotTag);
+	}
+}
+
+void UEquipmentManagerComponent::CancelPendingEquipmentItems(const FEquipmentChangeSet& ChangeSet)
+{
+	if (PendingEquipmentItems.IsEmpty())
+	{
+		return;
+	}
+
+	for (const auto& Change : ChangeSet.GetChanges())
+	{
+		if (Change.Type == EEquipmentChangeType::RemoveAll)
+		{
+			CancelAllPendingEquipmentItems();
+		}
+		else if ((Change.Type == EEquipmentChangeType::Add) || ((Change.Type == EEquipmentChangeType::Remove) && Change.SlotTag.IsValid()))
+		{
+			CancelPendingEquipmentItem(Change.SlotTag);
+		}
+	}
+}
+
+
 bool UEquipmentManagerComponent::GetActiveSlotInfo(FEquipmentSlotChangedMessage& SlotInfo) const
 {
 	return ActiveEquipments.GetActiveSlotInfo(SlotInfo);
 }
 
+bool UEquipmentManagerComponent::GetActiveSlotInfoInGroup(FGameplayTag ActiveGroup, FEquipmentSlotChangedMessage& SlotInfo) const
+{
+	const auto GroupIndex
+	{
+		SlotLayout ? SlotLayout->FindActiveGroupIndex(ActiveGroup) :
+		ActiveGroup.IsValid() ? INDEX_NONE : 0
+	};
+
+	return ActiveEquipments.GetActiveSlotInfo(SlotInfo, GroupIndex);
+}
+
 bool UEquipmentManagerComponent::GetSlotInfo(FGameplayTag SlotTag, FEquipmentSlotChangedMessage& SlotInfo) const
 {
 	return ActiveEquipments.GetSlotInfo(SlotTag, SlotInfo);
 }
 
+bool UEquipmentManagerComponent::GetEquipmentChangesSince(int64 SinceVersion, TArray<FEquipmentChangeRecord>& OutRecords, int64& OutVersion) const
+{
+	const auto& ChangeLog{ ActiveEquipments.GetChangeLog() };
+
+	OutVersion = ChangeLog.GetVersion();
+
+	return ChangeLog.GetChangesSince(SinceVersion, OutRecords);
+}
+
 
 UEquipmentManagerComponent* UEquipmentManagerComponent::FindEquipmentManagerComponent(const AActor* Actor)
 {
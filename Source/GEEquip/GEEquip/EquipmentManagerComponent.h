@@ -10,12 +10,42 @@
 #include "EquipmentManagerComponent.generated.h"
 
 class UEquipment;
+class UEquipmentSlotLayout;
+struct FEquipmentChangeSet;
+struct FStreamableHandle;
 
 
 /**
- * Delegate to notify changes in EquipmentSlot
+ * Delegate to notify the result of adding an equipment item asynchronously
  */
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FEquipmentSlotEventDelegate, FEquipmentSlotChangedMessage, Param);
+DECLARE_DELEGATE_TwoParams(FEquipmentItemAddedDelegate, bool /*bSucceeded*/, FActiveEquipmentHandle /*Handle*/);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FEquipmentItemAddedDynamicDelegate, bool, bSucceeded, FActiveEquipmentHandle, Handle);
+
+
+/**
+ * Equipment item that reserves a slot while its Equipment class is streamed in
+ */
+struct FPendingEquipmentItem
+{
+public:
+	FPendingEquipmentItem() {}
+
+public:
+	uint32 RequestId{ 0 };
+
+	TWeakObjectPtr<const UItemData> ItemData{ nullptr };
+
+	bool bEquipImmediately{ false };
+
+	FName ResolveContext{ NAME_None };
+
+	TSoftClassPtr<UEquipment> EquipmentClass;
+
+	TSharedPtr<FStreamableHandle> StreamingHandle;
+
+	FEquipmentItemAddedDelegate OnAdded;
+
+};
 
 
 /**
@@ -41,6 +71,7 @@ public:
 
 protected:
 	virtual void OnRegister() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	virtual void HandleChangeInitStateToDataInitialized(UGameFrameworkComponentManager* Manager) override;
 
@@ -60,6 +91,20 @@ private:
 	UPROPERTY(Replicated)
 	FActiveEquipmentContainer ActiveEquipments;
 
+protected:
+	//
+	// Fixed set of slots for the owner pawn type
+	// 
+	// Tips:
+	//	If set, only the slots defined in the layout can be used and they are stored in fixed slot-indexed storage.
+	//	If not set, any slot can be used.
+	//
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Equipments")
+	TObjectPtr<const UEquipmentSlotLayout> SlotLayout{ nullptr };
+
+public:
+	const UEquipmentSlotLayout* GetSlotLayout() const { return SlotLayout; }
+
 public:
 	UPROPERTY(BlueprintAssignable)
 	FEquipmentSlotEventDelegate OnEquipmentSlotChange;
@@ -67,14 +112,69 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FEquipmentSlotEventDelegate OnActiveEquipmentSlotChange;
 
+	//
+	// Native versions of the delegates above with a lightweight message
+	//
+	FEquipmentSlotNativeEventDelegate OnEquipmentSlotChangeNative;
+	FEquipmentSlotNativeEventDelegate OnActiveEquipmentSlotChangeNative;
+
+protected:
+	//
+	// Native listeners of slot changes filtered by slot
+	//
+	FEquipmentSlotListeners SlotChangeListeners;
+
+public:
+	/**
+	 * Listen to changes of only the specified slot instead of all slots
+	 * 
+	 * Tips:
+	 *	If bIncludeChildSlots is true, changes of the child slots are also received.
+	 */
+	FDelegateHandle AddSlotChangeListener(FGameplayTag SlotTag, FEquipmentSlotNativeEventDelegate::FDelegate Delegate, bool bIncludeChildSlots = false);
+
+	void RemoveSlotChangeListener(FGameplayTag SlotTag, FDelegateHandle Handle);
+	void RemoveAllSlotChangeListeners(const void* UserObject);
+
+	const FEquipmentSlotListeners& GetSlotChangeListeners() const { return SlotChangeListeners; }
+
+protected:
+	//
+	// Whether to collapse slot change messages per slot and send only the final state once at the end of frame
+	// 
+	// Tips:
+	//	Prevents listeners from rebuilding several times when the same slot is removed, given and equipped in one frame.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Equipments")
+	bool bCoalesceSlotChangeMessages{ false };
+
+	FDelegateHandle EndFrameDelegateHandle;
+
+public:
+	/**
+	 * Send the deferred slot change messages at the end of this frame
+	 */
+	void RequestFlushSlotChangeMessages();
+
+protected:
+	void HandleEndFrame();
+
 public:
 	void RegisterReplicatedSubobject(UEquipment* Instance);
 	void UnregisterReplicatedSubobject(UEquipment* Instance);
 
 
 public:
+	/**
+	 * Add the equipment item to the slot immediately
+	 * 
+	 * Tips:
+	 *	If the Equipment class is not loaded yet, it is loaded synchronously only if bAllowSyncEquipmentClassLoad is enabled.
+	 *	Use AddEquipmentItemAsync() or PrewarmEquipment() for items whose class may not be loaded.
+	 *	If bEquipImmediately is true, the equipment currently equipped in the same active group is unequipped first.
+	 */
 	UFUNCTION(BlueprintAuthorityOnly, BlueprintCallable, Category = "Equipments", meta = (GameplayTagFilter = "Equipment.Slot"))
-	bool AddEquipmentItem(FGameplayTag InSlotTag, const UItemData* InItemData, FActiveEquipmentHandle& OutHandle, bool bEquipImmediately = false);
+	bool AddEquipmentItem(FGameplayTag InSlotTag, const UItemData* InItemData, FActiveEquipmentHandle& OutHandle, bool bEquipImmediately = false, FName ResolveContext = NAME_None);
 
 
 	UFUNCTION(BlueprintAuthorityOnly, BlueprintCallable, Category = "Equipments", meta = (GameplayTagFilter = "Equipment.Slot"))
@@ -103,13 +203,95 @@ public:
 	UFUNCTION(BlueprintAuthorityOnly, BlueprintCallable, Category = "Equipments")
 	void UnequipEquipmentByHandle(FActiveEquipmentHandle Handle);
 
+
+	/**
+	 * Apply all changes recorded in the change set at once.
+	 * 
+	 * Tips:
+	 *	The array is compacted and marked dirty only once, 
+	 *	and the slot change message is sent only once for each changed slot.
+	 */
+	void CommitChangeSet(const FEquipmentChangeSet& ChangeSet, TArray<FActiveEquipmentHandle>& OutAddedHandles);
+
+
+	////////////////////////////////////////////////////////////////////////////////////
+	// Async Add
+protected:
+	//
+	// Items waiting for their Equipment class to be loaded for each reserved slot
+	//
+	TMap<FGameplayTag, FPendingEquipmentItem> PendingEquipmentItems;
+
+	//
+	// Id of the last requested pending item to ignore stale load completions
+	//
+	uint32 LastPendingRequestId{ 0 };
+
 public:
+	/**
+	 * Reserve the slot and add the equipment item after its Equipment class is streamed in without blocking.
+	 * 
+	 * Tips:
+	 *	Completes immediately if the class is already loaded.
+	 *	The request is cancelled and OnAdded is called with false if the slot is replaced or removed while loading.
+	 *	Returns false if the request could not be started.
+	 */
+	bool AddEquipmentItemAsync(FGameplayTag InSlotTag, const UItemData* InItemData, FEquipmentItemAddedDelegate OnAdded, bool bEquipImmediately = false, FName ResolveContext = NAME_None);
+
+	UFUNCTION(BlueprintAuthorityOnly, BlueprintCallable, Category = "Equipments", meta = (DisplayName = "Add Equipment Item Async", GameplayTagFilter = "Equipment.Slot"))
+	bool K2_AddEquipmentItemAsync(FGameplayTag InSlotTag, const UItemData* InItemData, FEquipmentItemAddedDynamicDelegate OnAdded, bool bEquipImmediately = false, FName ResolveContext = NAME_None);
+
+	UFUNCTION(BlueprintAuthorityOnly, BlueprintCallable, Category = "Equipments", meta = (GameplayTagFilter = "Equipment.Slot"))
+	bool CancelPendingEquipmentItem(FGameplayTag SlotTag);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Equipments", meta = (GameplayTagFilter = "Equipment.Slot"))
+	bool IsEquipmentItemPending(FGameplayTag SlotTag) const { return PendingEquipmentItems.Contains(SlotTag); }
+
+protected:
+	void HandleEquipmentClassLoaded(FGameplayTag SlotTag, uint32 RequestId);
+	void CancelAllPendingEquipmentItems();
+	void CancelPendingEquipmentItems(const FEquipmentChangeSet& ChangeSet);
+
+public:
+	/**
+	 * Returns the equipped entry of the default active group
+	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "Equipment")
 	bool GetActiveSlotInfo(FEquipmentSlotChangedMessage& SlotInfo) const;
 
+	/**
+	 * Returns the equipped entry of the active group defined in the slot layout
+	 *
+	 * Tips:
+	 *	Empty group returns the default active group.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "Equipment", meta = (GameplayTagFilter = "Equipment.ActiveGroup"))
+	bool GetActiveSlotInfoInGroup(FGameplayTag ActiveGroup, FEquipmentSlotChangedMessage& SlotInfo) const;
+
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "Equipment", meta = (GameplayTagFilter = "Equipment.Slot"))
 	bool GetSlotInfo(FGameplayTag SlotTag, FEquipmentSlotChangedMessage& SlotInfo) const;
 
+	/**
+	 * Returns the handle table that can be used to validate handles from any thread
+	 */
+	TSharedPtr<const FActiveEquipmentHandleTable, ESPMode::ThreadSafe> GetHandleTable() const { return ActiveEquipments.GetHandleTable(); }
+
+	/**
+	 * Returns the version of the latest change applied to the equipments
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Equipment")
+	int64 GetEquipmentChangeVersion() const { return ActiveEquipments.GetChangeLog().GetVersion(); }
+
+	/**
+	 * Get the changes applied after the version in order to apply them as deltas
+	 *
+	 * Tips:
+	 *	Returns false if the consumer has fallen behind the log and must re-read all slots.
+	 *	OutVersion is the version to pass next time.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "Equipment")
+	bool GetEquipmentChangesSince(int64 SinceVersion, TArray<FEquipmentChangeRecord>& OutRecords, int64& OutVersion) const;
+
 
 	////////////////////////////////////////////////////////////////////////////////////
 	// Utilities
@@ -4,9 +4,15 @@
 
 #include "EquipmentManagerComponent.h"
 #include "Item/ItemInfo_Equipment.h"
+#include "GEEquipLogs.h"
+#include "Type/EquipmentChangeSetTypes.h"
 
 #include "ItemData.h"
 
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+
 #if WITH_EDITOR
 #include "Misc/DataValidation.h"
 #endif
@@ -69,30 +75,240 @@ EDataValidationResult UEquipmentSet::IsDataValid(FDataValidationContext& Context
 #endif
 
 
-void UEquipmentSet::AddEquipmentItems(UEquipmentManagerComponent* Manager, TArray<FActiveEquipmentHandle>& OutHandles) const
+void UEquipmentSet::AddEquipmentItems(UEquipmentManagerComponent* Manager, TArray<FActiveEquipmentHandle>& OutHandles, FName ResolveContext) const
 {
 	if (Manager)
 	{
+		FEquipmentChangeSet ChangeSet;
+
 		for (const auto& KVP : Entries)
 		{
 			const auto& SlotTag{ KVP.Key };
-			const auto* ItemData
-			{  
-				KVP.Value.IsNull() ? nullptr :
-				KVP.Value.IsValid() ? KVP.Value.Get() : KVP.Value.LoadSynchronous()
-			};
 
-			FActiveEquipmentHandle OutHandle;
+			// Skip item data that are not loaded yet instead of blocking the game thread
 
-			if (Manager->AddEquipmentItem(SlotTag, ItemData, OutHandle))
+			const auto* ItemData{ KVP.Value.Get() };
+
+			if (!ItemData)
 			{
-				OutHandles.Emplace(OutHandle);
+				UE_CLOG(!KVP.Value.IsNull(), LogGameCore_Equipment, Warning, TEXT("Skipped item data [%s] of equipment set [%s] because it is not loaded. Use AddEquipmentItemsAsync() to load it first."), *KVP.Value.ToString(), *GetNameSafe(this));
+				continue;
 			}
+
+			ChangeSet.AddEquipmentItem(SlotTag, ItemData, false, ResolveContext);
 		}
 
 		if (DefaultActiveSlotTag.IsValid())
 		{
-			Manager->EquipEquipmentBySlot(DefaultActiveSlotTag);
+			ChangeSet.EquipEquipment(DefaultActiveSlotTag);
+		}
+
+		Manager->CommitChangeSet(ChangeSet, OutHandles);
+	}
+}
+
+TSharedPtr<FStreamableHandle> UEquipmentSet::AddEquipmentItemsAsync(UEquipmentManagerComponent* Manager, FEquipmentSetAppliedDelegate OnApplied, FName ResolveContext) const
+{
+	if (!Manager)
+	{
+		return nullptr;
+	}
+
+	TWeakObjectPtr<const ThisClass> WeakThis{ this };
+	TWeakObjectPtr<UEquipmentManagerComponent> WeakManager{ Manager };
+
+	// Classes for the context may be requested after the returned handle completes, so check it before applying
+
+	auto WeakLoadHandle{ MakeShared<TWeakPtr<FStreamableHandle>>() };
+
+	auto LoadHandle
+	{
+		LoadEquipmentItems(Manager, FStreamableDelegate::CreateLambda(
+			[WeakThis, WeakManager, OnApplied, ResolveContext, WeakLoadHandle]()
+			{
+				const auto LoadHandle{ WeakLoadHandle->Pin() };
+
+				if (LoadHandle.IsValid() && LoadHandle->WasCanceled())
+				{
+					return;
+				}
+
+				const auto* This{ WeakThis.Get() };
+				auto* Manager{ WeakManager.Get() };
+
+				if (This && Manager)
+				{
+					TArray<FActiveEquipmentHandle> Handles;
+					This->AddEquipmentItems(Manager, Handles, ResolveContext);
+
+					OnApplied.ExecuteIfBound(Handles);
+				}
+			}
+		), ResolveContext)
+	};
+
+	*WeakLoadHandle = LoadHandle;
+
+	return LoadHandle;
+}
+
+FEquipmentSetLoadHandle UEquipmentSet::K2_AddEquipmentItemsAsync(UEquipmentManagerComponent* Manager, FEquipmentSetAppliedDynamicDelegate OnApplied, FName ResolveContext) const
+{
+	return FEquipmentSetLoadHandle(AddEquipmentItemsAsync(Manager, FEquipmentSetAppliedDelegate::CreateLambda(
+		[OnApplied](const TArray<FActiveEquipmentHandle>& Handles)
+		{
+			OnApplied.ExecuteIfBound(Handles);
 		}
+	), ResolveContext));
+}
+
+void UEquipmentSet::CancelEquipmentItemsAsync(FEquipmentSetLoadHandle& Handle)
+{
+	if (Handle.StreamingHandle.IsValid())
+	{
+		Handle.StreamingHandle->CancelHandle();
+		Handle.StreamingHandle.Reset();
+	}
+}
+
+TSharedPtr<FStreamableHandle> UEquipmentSet::LoadEquipmentItems(const UObject* WorldContextObject, FStreamableDelegate OnLoaded, FName ResolveContext) const
+{
+	auto& AssetManager{ UAssetManager::Get() };
+
+	// Item data that are primary assets are loaded with their bundles including the equipment class.
+	// Classes of already loaded item data are requested directly so that custom equipment infos are respected.
+
+	TArray<FPrimaryAssetId> AssetIdsToLoad;
+	TArray<FSoftObjectPath> PathsToLoad;
+
+	for (const auto& KVP : Entries)
+	{
+		const auto& SoftItemData{ KVP.Value };
+
+		if (SoftItemData.IsNull())
+		{
+			continue;
+		}
+
+		if (!SoftItemData.Get())
+		{
+			const auto AssetId{ AssetManager.GetPrimaryAssetIdForPath(SoftItemData.ToSoftObjectPath()) };
+
+			if (AssetId.IsValid())
+			{
+				AssetIdsToLoad.AddUnique(AssetId);
+			}
+			else
+			{
+				PathsToLoad.AddUnique(SoftItemData.ToSoftObjectPath());
+			}
+		}
+	}
+
+	GatherEquipmentClassesToLoad(ResolveContext, PathsToLoad);
+
+	// Request all as one batch
+
+	TArray<TSharedPtr<FStreamableHandle>> Handles;
+
+	if (!AssetIdsToLoad.IsEmpty())
+	{
+		TArray<FName> Bundles;
+		GetBundlesToLoad(WorldContextObject, Bundles);
+
+		if (auto Handle{ AssetManager.LoadPrimaryAssets(AssetIdsToLoad, Bundles) })
+		{
+			Handles.Add(Handle);
+		}
+	}
+
+	if (!PathsToLoad.IsEmpty())
+	{
+		if (auto Handle{ AssetManager.GetStreamableManager().RequestAsyncLoad(PathsToLoad) })
+		{
+			Handles.Add(Handle);
+		}
+	}
+
+	TSharedPtr<FStreamableHandle> LoadHandle
+	{
+		Handles.IsEmpty() ? nullptr :
+		(Handles.Num() == 1) ? Handles[0] : AssetManager.GetStreamableManager().CreateCombinedHandle(Handles)
+	};
+
+	// Bundles only contain the default Equipment class, so request the classes for the context once the item data are loaded
+
+	if (!AssetIdsToLoad.IsEmpty() && !ResolveContext.IsNone())
+	{
+		TWeakObjectPtr<const ThisClass> WeakThis{ this };
+
+		OnLoaded = FStreamableDelegate::CreateLambda(
+			[WeakThis, OnLoaded, ResolveContext]()
+			{
+				TArray<FSoftObjectPath> ClassPaths;
+
+				if (const auto* This{ WeakThis.Get() })
+				{
+					This->GatherEquipmentClassesToLoad(ResolveContext, ClassPaths);
+				}
+
+				if (ClassPaths.IsEmpty() || !UAssetManager::GetStreamableManager().RequestAsyncLoad(ClassPaths, OnLoaded))
+				{
+					OnLoaded.ExecuteIfBound();
+				}
+			}
+		);
+	}
+
+	// Complete immediately if there is nothing to wait for
+
+	if (!LoadHandle.IsValid() || LoadHandle->HasLoadCompleted())
+	{
+		OnLoaded.ExecuteIfBound();
+		return nullptr;
+	}
+
+	LoadHandle->BindCompleteDelegate(MoveTemp(OnLoaded));
+
+	return LoadHandle;
+}
+
+void UEquipmentSet::GatherEquipmentClassesToLoad(FName ResolveContext, TArray<FSoftObjectPath>& OutPaths) const
+{
+	// Classes of already loaded item data are requested directly so that custom equipment infos are respected
+
+	for (const auto& KVP : Entries)
+	{
+		const auto* ItemData{ KVP.Value.Get() };
+		const auto* EquipmentInfo{ ItemData ? ItemData->FindInfo<UItemInfo_Equipment>() : nullptr };
+
+		if (EquipmentInfo)
+		{
+			const auto SoftEquipmentClass{ EquipmentInfo->GetSoftEquipmentClassForContext(ResolveContext) };
+
+			if (!SoftEquipmentClass.IsNull() && !SoftEquipmentClass.Get())
+			{
+				OutPaths.AddUnique(SoftEquipmentClass.ToSoftObjectPath());
+			}
+		}
+	}
+}
+
+void UEquipmentSet::GetBundlesToLoad(const UObject* WorldContextObject, TArray<FName>& OutBundles) const
+{
+	static const FName NAME_Client{ TEXTVIEW("Client") };
+	static const FName NAME_Server{ TEXTVIEW("Server") };
+
+	const auto* World{ WorldContextObject ? WorldContextObject->GetWorld() : nullptr };
+	const auto NetMode{ World ? World->GetNetMode() : NM_Standalone };
+
+	if (NetMode != NM_Client)
+	{
+		OutBundles.Add(NAME_Server);
+	}
+
+	if (NetMode != NM_DedicatedServer)
+	{
+		OutBundles.Add(NAME_Client);
 	}
 }
@@ -12,6 +12,39 @@
 
 class UItemData;
 class UEquipmentManagerComponent;
+struct FStreamableHandle;
+
+
+/**
+ * Delegate to notify that the equipment set has been loaded and applied
+ */
+DECLARE_DELEGATE_OneParam(FEquipmentSetAppliedDelegate, const TArray<FActiveEquipmentHandle>& /*Handles*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FEquipmentSetAppliedDynamicDelegate, const TArray<FActiveEquipmentHandle>&, Handles);
+
+
+/**
+ * Handle to cancel adding the items of an equipment set asynchronously from Blueprint
+ */
+USTRUCT(BlueprintType)
+struct FEquipmentSetLoadHandle
+{
+	GENERATED_BODY()
+public:
+	FEquipmentSetLoadHandle() {}
+	FEquipmentSetLoadHandle(const TSharedPtr<FStreamableHandle>& InStreamingHandle)
+		: StreamingHandle(InStreamingHandle)
+	{}
+
+public:
+	TSharedPtr<FStreamableHandle> StreamingHandle;
+
+public:
+	/**
+	 * Returns whether the items were still loading when they were requested
+	 */
+	bool IsValid() const { return StreamingHandle.IsValid(); }
+
+};
 
 
 /**
@@ -41,7 +74,46 @@ public:
 	FGameplayTag DefaultActiveSlotTag;
 
 public:
+	/**
+	 * Add all equipment items at once
+	 * 
+	 * Tips:
+	 *	Items whose item data is not loaded yet are skipped and never loaded synchronously.
+	 *	Use AddEquipmentItemsAsync() to load the item data and their Equipment classes first.
+	 */
 	UFUNCTION(BlueprintAuthorityOnly, BlueprintCallable, BlueprintPure = false, Category = "Equipments")
-	void AddEquipmentItems(UEquipmentManagerComponent* Manager, TArray<FActiveEquipmentHandle>& OutHandles) const;
+	void AddEquipmentItems(UEquipmentManagerComponent* Manager, TArray<FActiveEquipmentHandle>& OutHandles, FName ResolveContext = NAME_None) const;
+
+	/**
+	 * Load all item data, equipment classes and their bundles in one batch and add them after loading is complete.
+	 * 
+	 * Tips:
+	 *	Returns nullptr if everything is already loaded and the items have been added immediately.
+	 *	Cancel the returned handle to stop adding the items, including while the classes for ResolveContext are loading.
+	 */
+	TSharedPtr<FStreamableHandle> AddEquipmentItemsAsync(UEquipmentManagerComponent* Manager, FEquipmentSetAppliedDelegate OnApplied, FName ResolveContext = NAME_None) const;
+
+	UFUNCTION(BlueprintAuthorityOnly, BlueprintCallable, Category = "Equipments", meta = (DisplayName = "Add Equipment Items Async"))
+	FEquipmentSetLoadHandle K2_AddEquipmentItemsAsync(UEquipmentManagerComponent* Manager, FEquipmentSetAppliedDynamicDelegate OnApplied, FName ResolveContext = NAME_None) const;
+
+	/**
+	 * Stop adding the items requested by K2_AddEquipmentItemsAsync()
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Equipments")
+	static void CancelEquipmentItemsAsync(UPARAM(ref) FEquipmentSetLoadHandle& Handle);
+
+	/**
+	 * Load all item data, equipment classes and their bundles in one batch.
+	 *
+	 * Tips:
+	 *	Returns nullptr and calls OnLoaded immediately if everything is already loaded.
+	 *	Equipment classes are those returned for ResolveContext. Classes of item data that were not loaded yet
+	 *	are requested in a second batch after the item data if ResolveContext is not NAME_None.
+	 */
+	TSharedPtr<FStreamableHandle> LoadEquipmentItems(const UObject* WorldContextObject, FStreamableDelegate OnLoaded, FName ResolveContext = NAME_None) const;
+
+protected:
+	void GetBundlesToLoad(const UObject* WorldContextObject, TArray<FName>& OutBundles) const;
+	void GatherEquipmentClassesToLoad(FName ResolveContext, TArray<FSoftObjectPath>& OutPaths) const;
 
 };
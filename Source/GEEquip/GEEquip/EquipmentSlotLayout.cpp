@@ -0,0 +1,118 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "EquipmentSlotLayout.h"
+
+#if WITH_EDITOR
+#include "Misc/DataValidation.h"
+#endif
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentSlotLayout)
+
+
+UEquipmentSlotLayout::UEquipmentSlotLayout(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+
+void UEquipmentSlotLayout::PostLoad()
+{
+	Super::PostLoad();
+
+	RebuildIndices();
+}
+
+#if WITH_EDITOR
+void UEquipmentSlotLayout::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	RebuildIndices();
+}
+
+EDataValidationResult UEquipmentSlotLayout::IsDataValid(FDataValidationContext& Context) const
+{
+	auto Result{ CombineDataValidationResults(Super::IsDataValid(Context), EDataValidationResult::Valid) };
+
+	if (Slots.Num() > MaxSlots)
+	{
+		Result = CombineDataValidationResults(Result, EDataValidationResult::Invalid);
+
+		Context.AddError(FText::FromString(FString::Printf(TEXT("Too many slots defined in %s (Max: %d)"), *GetNameSafe(this), MaxSlots)));
+	}
+
+	TSet<FGameplayTag> SlotTags;
+
+	for (auto It{ Slots.CreateConstIterator() }; It; ++It)
+	{
+		if (!It->SlotTag.IsValid())
+		{
+			Result = CombineDataValidationResults(Result, EDataValidationResult::Invalid);
+
+			Context.AddError(FText::FromString(FString::Printf(TEXT("Invalid SlotTag defined in Slots[%d] in %s"), It.GetIndex(), *GetNameSafe(this))));
+		}
+		else if (SlotTags.Contains(It->SlotTag))
+		{
+			Result = CombineDataValidationResults(Result, EDataValidationResult::Invalid);
+
+			Context.AddError(FText::FromString(FString::Printf(TEXT("Duplicate SlotTag(%s) defined in Slots[%d] in %s"), *It->SlotTag.ToString(), It.GetIndex(), *GetNameSafe(this))));
+		}
+
+		SlotTags.Add(It->SlotTag);
+
+		if (It->ActiveGroup.IsValid() && !ActiveGroups.Contains(It->ActiveGroup))
+		{
+			Result = CombineDataValidationResults(Result, EDataValidationResult::Invalid);
+
+			Context.AddError(FText::FromString(FString::Printf(TEXT("ActiveGroup(%s) in Slots[%d] is not defined in ActiveGroups in %s"), *It->ActiveGroup.ToString(), It.GetIndex(), *GetNameSafe(this))));
+		}
+	}
+
+	return Result;
+}
+#endif
+
+
+void UEquipmentSlotLayout::RebuildIndices()
+{
+	SlotToIndex.Reset();
+	SlotToIndex.Reserve(Slots.Num());
+
+	SlotToActiveGroup.Reset(Slots.Num());
+
+	for (auto It{ Slots.CreateConstIterator() }; It; ++It)
+	{
+		if (It->SlotTag.IsValid() && (It.GetIndex() < MaxSlots))
+		{
+			SlotToIndex.FindOrAdd(It->SlotTag, It.GetIndex());
+		}
+
+		// Undefined groups fall back to the default group
+
+		SlotToActiveGroup.Add(FMath::Max(FindActiveGroupIndex(It->ActiveGroup), 0));
+	}
+}
+
+int32 UEquipmentSlotLayout::FindActiveGroupIndex(const FGameplayTag& ActiveGroup) const
+{
+	if (!ActiveGroup.IsValid())
+	{
+		return 0;
+	}
+
+	const auto Index{ ActiveGroups.IndexOfByKey(ActiveGroup) };
+
+	return (Index != INDEX_NONE) ? (Index + 1) : INDEX_NONE;
+}
+
+int32 UEquipmentSlotLayout::FindSlotIndex(const FGameplayTag& SlotTag) const
+{
+	const auto* Index{ SlotToIndex.Find(SlotTag) };
+
+	return Index ? *Index : INDEX_NONE;
+}
+
+FGameplayTag UEquipmentSlotLayout::GetSlotTag(int32 SlotIndex) const
+{
+	return Slots.IsValidIndex(SlotIndex) ? Slots[SlotIndex].SlotTag : FGameplayTag::EmptyTag;
+}
@@ -0,0 +1,128 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+
+#include "Type/EquipmentSlotRuleTypes.h"
+
+#include "GameplayTagContainer.h"
+
+#include "EquipmentSlotLayout.generated.h"
+
+
+/**
+ * Definition of a slot in the slot layout
+ */
+USTRUCT(BlueprintType)
+struct GEEQUIP_API FEquipmentSlotDefinition
+{
+	GENERATED_BODY()
+public:
+	FEquipmentSlotDefinition() {}
+
+public:
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Slot", meta = (Categories = "Equipment.Slot"))
+	FGameplayTag SlotTag;
+
+	//
+	// Group in which only one slot can be equipped at a time (default group if not specified)
+	//
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Slot", meta = (Categories = "Equipment.ActiveGroup"))
+	FGameplayTag ActiveGroup;
+
+	//
+	// Rules applied to any equipment item in this slot in addition to the rules of the item
+	//
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Slot")
+	FEquipmentSlotRules Rules;
+
+};
+
+
+/**
+ * Data asset that defines the fixed set of slots available for a pawn type
+ * 
+ * Tips:
+ *	When set to EquipmentManagerComponent, entries are stored and looked up by the index of the slot in this layout
+ *	and the index is replicated instead of the slot tag.
+ *	Each active group has its own equipped entry, e.g. main hand, off hand and head-mounted gadget.
+ *	The layout must be the same on the server and clients.
+ */
+UCLASS(BlueprintType, Const)
+class GEEQUIP_API UEquipmentSlotLayout : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+public:
+	UEquipmentSlotLayout(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	//
+	// Maximum number of slots that can be defined so that the slot index fits in 8 bits
+	//
+	static constexpr int32 MaxSlots{ MAX_uint8 };
+
+public:
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+#endif
+
+protected:
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Slots", meta = (TitleProperty = "SlotTag"))
+	TArray<FEquipmentSlotDefinition> Slots;
+
+	//
+	// Groups that each have their own equipped entry
+	// 
+	// Tips:
+	//	Slots without an active group belong to the default group of index 0, and ActiveGroups[i] has index i + 1.
+	//
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Slots", meta = (Categories = "Equipment.ActiveGroup"))
+	TArray<FGameplayTag> ActiveGroups;
+
+	//
+	// Index in Slots for each slot tag
+	//
+	TMap<FGameplayTag, int32> SlotToIndex;
+
+	//
+	// Index of the active group for each index in Slots
+	//
+	TArray<int32> SlotToActiveGroup;
+
+protected:
+	void RebuildIndices();
+
+public:
+	/**
+	 * Returns the index of the slot in this layout or INDEX_NONE if it is not defined
+	 */
+	int32 FindSlotIndex(const FGameplayTag& SlotTag) const;
+
+	/**
+	 * Returns the slot tag of the index or empty tag if the index is out of range
+	 */
+	FGameplayTag GetSlotTag(int32 SlotIndex) const;
+
+	int32 GetNumSlots() const { return Slots.Num(); }
+
+	/**
+	 * Returns the index of the active group or INDEX_NONE if it is not defined
+	 * 
+	 * Tips:
+	 *	Empty tag returns the default group of index 0.
+	 */
+	int32 FindActiveGroupIndex(const FGameplayTag& ActiveGroup) const;
+
+	/**
+	 * Returns the index of the active group of the slot or the default group if the index is out of range
+	 */
+	int32 GetActiveGroupIndex(int32 SlotIndex) const { return SlotToActiveGroup.IsValidIndex(SlotIndex) ? SlotToActiveGroup[SlotIndex] : 0; }
+
+	int32 GetNumActiveGroups() const { return ActiveGroups.Num() + 1; }
+
+	const TArray<FEquipmentSlotDefinition>& GetSlots() const { return Slots; }
+
+};
@@ -7,3 +7,9 @@
 // Equipment.Slot
 
 UE_DEFINE_GAMEPLAY_TAG(TAG_Equipment_Slot, "Equipment.Slot");
+
+
+////////////////////////////////////
+// Equipment.ActiveGroup
+
+UE_DEFINE_GAMEPLAY_TAG(TAG_Equipment_ActiveGroup, "Equipment.ActiveGroup");
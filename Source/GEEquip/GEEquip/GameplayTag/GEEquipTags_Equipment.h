@@ -9,3 +9,9 @@
 // Equipment.Slot
 
 GEEQUIP_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Equipment_Slot);
+
+
+////////////////////////////////////
+// Equipment.ActiveGroup
+
+GEEQUIP_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Equipment_ActiveGroup);
@@ -2,6 +2,7 @@
 
 #include "ItemInfo_Equipment.h"
 
+#include "Development/GEEquipDeveloperSettings.h"
 #include "GEEquipLogs.h"
 
 #if WITH_EDITOR
@@ -31,18 +32,61 @@ EDataValidationResult UItemInfo_Equipment::IsDataValid(FDataValidationContext& C
 
 	return Result;
 }
+
+void UItemInfo_Equipment::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	AddableSlotMask.Invalidate();
+}
 #endif
 
 
+void UItemInfo_Equipment::PostLoad()
+{
+	Super::PostLoad();
+
+	AddableSlotMask.Update(GetAddableSlots());
+}
+
+bool UItemInfo_Equipment::CanAddToSlot(const FGameplayTag& SlotTag) const
+{
+	const auto& Slots{ GetAddableSlots() };
+
+	return !Slots.IsValid() || AddableSlotMask.HasSlot(Slots, SlotTag);
+}
+
+
 TSubclassOf<UEquipment> UItemInfo_Equipment::GetEquipmentClass() const
 {
-	if (!EquipmentClass.IsValid())
-	{
-		UE_LOG(LogGameCore_Equipment, Warning, TEXT("You attempted to create ActiveEquipment with no Equipment class loaded."));
-		UE_LOG(LogGameCore_Equipment, Warning, TEXT("Please load the 'Equipment' bundle of the primary asset in advance for efficiency."));
+	return ResolveSoftEquipmentClass(EquipmentClass);
+}
 
-		return EquipmentClass.LoadSynchronous();
+TSubclassOf<UEquipment> UItemInfo_Equipment::GetEquipmentClassForContext(FName ContextKey) const
+{
+	return ContextKey.IsNone() ? GetEquipmentClass() : ResolveSoftEquipmentClass(GetSoftEquipmentClassForContext(ContextKey));
+}
+
+TSubclassOf<UEquipment> UItemInfo_Equipment::ResolveSoftEquipmentClass(const TSoftClassPtr<UEquipment>& InEquipmentClass)
+{
+	if (InEquipmentClass.IsNull() || InEquipmentClass.IsValid())
+	{
+		return InEquipmentClass.Get();
 	}
 
-	return EquipmentClass.Get();
+	// Warn only once for each class so that repeated adds do not flood the log
+
+	const auto bAllowSyncLoad{ GetDefault<UGEEquipDeveloperSettings>()->bAllowSyncEquipmentClassLoad };
+
+	static TSet<FSoftObjectPath> WarnedClasses;
+
+	auto bAlreadyWarned{ false };
+	WarnedClasses.Add(InEquipmentClass.ToSoftObjectPath(), &bAlreadyWarned);
+
+	UE_CLOG(!bAlreadyWarned, LogGameCore_Equipment, Warning, TEXT("You attempted to create ActiveEquipment with no Equipment class [%s] loaded%s. Please use AddEquipmentItemAsync() or PrewarmEquipment(), or load the bundles of the primary asset in advance."),
+		*InEquipmentClass.ToString(), bAllowSyncLoad ? TEXT(", so it is loaded synchronously") : TEXT(""));
+
+	// Load synchronously as a last resort only if allowed in the settings
+
+	return bAllowSyncLoad ? InEquipmentClass.LoadSynchronous() : nullptr;
 }
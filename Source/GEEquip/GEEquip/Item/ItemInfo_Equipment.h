@@ -4,6 +4,9 @@
 
 #include "Info/ItemInfo.h"
 
+#include "Type/EquipmentSlotTypes.h"
+#include "Type/EquipmentSlotRuleTypes.h"
+
 #include "GameplayTagContainer.h"
 
 #include "ItemInfo_Equipment.generated.h"
@@ -11,6 +14,20 @@
 class UEquipment;
 
 
+/**
+ * How long the assets of the equipment item stay loaded by the equipment asset registry
+ */
+UENUM(BlueprintType)
+enum class EEquipmentResidency : uint8
+{
+	// Loaded when requested and released when no longer needed, e.g. rare items
+	OnDemand,
+
+	// Loaded when scanned and kept loaded for the lifetime of the game instance, e.g. starter weapons
+	AlwaysResident
+};
+
+
 /**
  * Item information for equipment
  * 
@@ -18,11 +35,16 @@ class UEquipment;
  *	This ItemInfo is always required for the EquipmentManager to recognize this item as equipment.
  * 
  * Tips:
- *	By inheriting this class and overriding GetEquipmentClass(), 
- *	it can be customized to return any Equipment class from other system values.
+ *	By inheriting this class and overriding GetSoftEquipmentClassForContext(), 
+ *	it can be customized to return any Equipment class for the resolve context passed when adding equipment.
  * 
  *	This allows, for example, to have an Equipment class for each skin 
- *	and return the corresponding Equipment class for the skin being applied from another system.
+ *	and return the corresponding Equipment class for the skin id used as the resolve context.
+ * 
+ *	GetEquipmentClassForContext() resolves the class returned by GetSoftEquipmentClassForContext(),
+ *	so that asynchronous loading streams the same class that is added.
+ *	The classes are resolved when adding equipment and should not be loaded synchronously.
+ *	If they are not loaded, ResolveSoftEquipmentClass() falls back to a synchronous load only if allowed in the settings.
  */
 UCLASS(meta = (DisplayName = "Equipment Info"))
 class GEEQUIP_API UItemInfo_Equipment : public UItemInfo
@@ -36,8 +58,12 @@ public:
 public:
 #if WITH_EDITOR 
 	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
+public:
+	virtual void PostLoad() override;
+
 protected:
 	//
 	// List of slots to which this equipment item can be added.
@@ -48,14 +74,64 @@ protected:
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Equipment", meta = (Categories = "Equipment.Slot"))
 	FGameplayTagContainer AddableSlots;
 
+	//
+	// Bit set of AddableSlots and their parents by slot index
+	//
+	mutable FEquipmentSlotMaskCache AddableSlotMask;
+
+	//
+	// Rules on which slots can be occupied together with this equipment item
+	//
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Equipment")
+	FEquipmentSlotRules SlotRules;
+
 	//
 	// Definition class of equipment to be added
 	//
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Equipment", meta = (AssetBundles = "Client, Server"))
 	TSoftClassPtr<UEquipment> EquipmentClass;
 
+	//
+	// How long the Equipment class stays loaded by the equipment asset registry
+	//
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Equipment")
+	EEquipmentResidency Residency{ EEquipmentResidency::OnDemand };
+
 public:
+	EEquipmentResidency GetResidency() const { return Residency; }
 	virtual const FGameplayTagContainer& GetAddableSlots() const { return AddableSlots; }
+	virtual const FEquipmentSlotRules& GetSlotRules() const { return SlotRules; }
 	virtual TSubclassOf<UEquipment> GetEquipmentClass() const;
+	virtual TSoftClassPtr<UEquipment> GetSoftEquipmentClass() const { return EquipmentClass; }
+
+	/**
+	 * Returns the Equipment class to stream in and add for the resolve context, e.g. the skin id
+	 * 
+	 * Tips:
+	 *	Returns GetSoftEquipmentClass() by default.
+	 */
+	virtual TSoftClassPtr<UEquipment> GetSoftEquipmentClassForContext(FName ContextKey) const { return GetSoftEquipmentClass(); }
+
+	/**
+	 * Returns the Equipment class for the resolve context if it is already loaded
+	 * 
+	 * Tips:
+	 *	Returns GetEquipmentClass() for NAME_None, otherwise resolves GetSoftEquipmentClassForContext().
+	 */
+	virtual TSubclassOf<UEquipment> GetEquipmentClassForContext(FName ContextKey) const;
+
+	/**
+	 * Returns whether this item can be added to the slot with a single bit test
+	 */
+	bool CanAddToSlot(const FGameplayTag& SlotTag) const;
+
+	/**
+	 * Returns the Equipment class if it is already loaded
+	 * 
+	 * Tips:
+	 *	Otherwise warns once for the class and loads it synchronously only if bAllowSyncEquipmentClassLoad is enabled.
+	 *	Shared with the entries of the equipment catalog.
+	 */
+	static TSubclassOf<UEquipment> ResolveSoftEquipmentClass(const TSoftClassPtr<UEquipment>& InEquipmentClass);
 
 };
@@ -0,0 +1,784 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "EquipmentAssetRegistrySubsystem.h"
+
+#include "Development/GEEquipDeveloperSettings.h"
+#include "EquipmentCatalog.h"
+#include "Equipment/Equipment.h"
+#include "Equipment/Fragment/EquipmentFragment.h"
+#include "GEEquipLogs.h"
+
+#include "ItemData.h"
+
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentAssetRegistrySubsystem)
+
+
+static FAutoConsoleCommandWithWorld CmdEquipmentAssetRegistryStats(
+	TEXT("GEEquip.AssetRegistry.Stats"),
+	TEXT("Print the number of registered and pinned equipment items and the memory held by the equipment asset registry."),
+	FConsoleCommandWithWorldDelegate::CreateLambda(
+		[](UWorld* World)
+		{
+			if (auto* Registry{ UEquipmentAssetRegistrySubsystem::Get(World) })
+			{
+				UE_LOG(LogGameCore_Equipment, Display, TEXT("EquipmentAssetRegistry: %s"), *Registry->GetStats().ToString());
+			}
+		}
+	));
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// FEquipmentAssetRegistryEntry
+
+bool FEquipmentAssetRegistryEntry::IsPinned() const
+{
+	if (!PinHandle.IsValid() || !PinHandle->HasLoadCompleted() || PinHandle->WasCanceled())
+	{
+		return false;
+	}
+
+	return !FragmentAssetsHandle.IsValid() || FragmentAssetsHandle->HasLoadCompleted();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// FEquipmentAssetRegistryStats
+
+FString FEquipmentAssetRegistryStats::ToString() const
+{
+	return FString::Printf(TEXT("Registered: %d, Pinned: %d, AlwaysResident: %d, InUse: %d, PinnedMemory: %.2f KB / %.2f KB, Hits: %lld, Misses: %lld, Evictions: %lld")
+		, NumRegistered, NumPinned, NumAlwaysResident, NumInUse
+		, static_cast<double>(PinnedResourceBytes) / 1024.0, static_cast<double>(BudgetBytes) / 1024.0
+		, NumHits, NumMisses, NumEvictions);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// UEquipmentAssetRegistrySubsystem
+
+void UEquipmentAssetRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const auto* Settings{ GetDefault<UGEEquipDeveloperSettings>() };
+
+	bDedicatedServer = GetGameInstance()->IsDedicatedServerInstance();
+
+	// Load the catalog once so that lookups never load at runtime.
+	// Uncooked builds resolve from the live equipment infos so that edits in the editor are never hidden by stale baked data.
+
+	if (FPlatformProperties::RequiresCookedData() && !Settings->EquipmentCatalog.IsNull())
+	{
+		Catalog = Settings->EquipmentCatalog.LoadSynchronous();
+
+		UE_CLOG(!Catalog, LogGameCore_Equipment, Warning, TEXT("Failed to load equipment catalog [%s]"), *Settings->EquipmentCatalog.ToString());
+	}
+
+	if (Settings->bScanOnStartup)
+	{
+		UAssetManager::CallOrRegister_OnCompletedInitialScan(FSimpleMulticastDelegate::FDelegate::CreateUObject(this, &ThisClass::ScanEquipmentItems));
+	}
+
+	if (Settings->bScanOnMapLoad)
+	{
+		PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ThisClass::HandlePostLoadMap);
+	}
+}
+
+void UEquipmentAssetRegistrySubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+	if (ScanHandle.IsValid())
+	{
+		ScanHandle->CancelHandle();
+		ScanHandle.Reset();
+	}
+
+	for (auto& KVP : Entries)
+	{
+		UnpinEntry(KVP.Value);
+	}
+
+	Entries.Empty();
+	ScannedAssetIds.Empty();
+	Resolutions.Empty();
+	Catalog = nullptr;
+
+	Super::Deinitialize();
+}
+
+
+void UEquipmentAssetRegistrySubsystem::ScanEquipmentItems()
+{
+	// Suspend if scanning is in progress
+
+	if (ScanHandle.IsValid() && ScanHandle->IsLoadingInProgress())
+	{
+		return;
+	}
+
+	// Find item data that have not been scanned yet
+
+	auto& AssetManager{ UAssetManager::Get() };
+
+	TArray<FPrimaryAssetId> AssetIdsToScan;
+
+	for (const auto& AssetType : GetDefault<UGEEquipDeveloperSettings>()->ItemAssetTypes)
+	{
+		TArray<FPrimaryAssetId> AssetIds;
+		AssetManager.GetPrimaryAssetIdList(AssetType, AssetIds);
+
+		for (const auto& AssetId : AssetIds)
+		{
+			if (!ScannedAssetIds.Contains(AssetId))
+			{
+				AssetIdsToScan.Add(AssetId);
+			}
+		}
+	}
+
+	if (AssetIdsToScan.IsEmpty())
+	{
+		return;
+	}
+
+	// Load only the item data since the Equipment classes are pinned by residency.
+	// Keep the current bundle state of the items so that bundles loaded by others are not unloaded.
+
+	ScanHandle = AssetManager.ChangeBundleStateForPrimaryAssets(
+		AssetIdsToScan, TArray<FName>(), TArray<FName>(), false
+		, FStreamableDelegate::CreateUObject(this, &ThisClass::HandleItemDataScanned, AssetIdsToScan));
+}
+
+void UEquipmentAssetRegistrySubsystem::HandleItemDataScanned(TArray<FPrimaryAssetId> AssetIds)
+{
+	auto& AssetManager{ UAssetManager::Get() };
+
+	auto NumRegistered{ 0 };
+
+	for (const auto& AssetId : AssetIds)
+	{
+		ScannedAssetIds.Add(AssetId);
+
+		if (RegisterEquipmentItem(AssetManager.GetPrimaryAssetObject<UItemData>(AssetId)))
+		{
+			NumRegistered++;
+		}
+	}
+
+	UE_LOG(LogGameCore_Equipment, Log, TEXT("Scanned %d item data and registered %d equipment items (%s)"), AssetIds.Num(), NumRegistered, *GetStats().ToString());
+}
+
+void UEquipmentAssetRegistrySubsystem::HandlePostLoadMap(UWorld* LoadedWorld)
+{
+	ScanEquipmentItems();
+}
+
+
+bool UEquipmentAssetRegistrySubsystem::RegisterEquipmentItem(const UItemData* ItemData)
+{
+	if (!ItemData)
+	{
+		return false;
+	}
+
+	if (Entries.Contains(ItemData))
+	{
+		return true;
+	}
+
+	// Suspend if No Equipment Info in ItemData
+
+	const auto* EquipmentInfo{ ItemData->FindInfo<UItemInfo_Equipment>() };
+
+	if (!EquipmentInfo)
+	{
+		return false;
+	}
+
+	auto& NewEntry{ Entries.Add(ItemData) };
+	NewEntry.EquipmentClass = EquipmentInfo->GetSoftEquipmentClass();
+	NewEntry.Residency = EquipmentInfo->GetResidency();
+
+	if (NewEntry.Residency == EEquipmentResidency::AlwaysResident)
+	{
+		PinEntry(ItemData, NewEntry, FStreamableManager::AsyncLoadHighPriority);
+	}
+
+	return true;
+}
+
+const FEquipmentCatalogEntry* UEquipmentAssetRegistrySubsystem::FindCatalogEntry(const UItemData* ItemData) const
+{
+	return Catalog ? Catalog->FindEntry(ItemData) : nullptr;
+}
+
+bool UEquipmentAssetRegistrySubsystem::ResolveEquipment(const UItemData* ItemData, FName ContextKey, const UItemInfo_Equipment*& OutEquipmentInfo, TSubclassOf<UEquipment>& OutEquipmentClass)
+{
+	if (!ItemData)
+	{
+		return false;
+	}
+
+	// Use cached result if it is still alive
+
+	const FEquipmentResolutionKey Key{ ItemData, ContextKey };
+
+	if (const auto* Resolution{ Resolutions.Find(Key) })
+	{
+		const auto* EquipmentInfo{ Resolution->EquipmentInfo.Get() };
+		auto* EquipmentClass{ Resolution->EquipmentClass.Get() };
+
+		if (EquipmentInfo && EquipmentClass)
+		{
+			OutEquipmentInfo = EquipmentInfo;
+			OutEquipmentClass = EquipmentClass;
+			return true;
+		}
+	}
+
+	// Resolve and cache
+
+	const auto* EquipmentInfo{ ItemData->FindInfo<UItemInfo_Equipment>() };
+
+	if (!EquipmentInfo)
+	{
+		return false;
+	}
+
+	const auto EquipmentClass{ EquipmentInfo->GetEquipmentClassForContext(ContextKey) };
+
+	if (!EquipmentClass)
+	{
+		return false;
+	}
+
+	auto& NewResolution{ Resolutions.Add(Key) };
+	NewResolution.EquipmentInfo = EquipmentInfo;
+	NewResolution.EquipmentClass = EquipmentClass.Get();
+
+	OutEquipmentInfo = EquipmentInfo;
+	OutEquipmentClass = EquipmentClass;
+
+	return true;
+}
+
+void UEquipmentAssetRegistrySubsystem::InvalidateResolutionsForItem(const UItemData* ItemData)
+{
+	const TObjectKey<UItemData> ItemDataKey{ ItemData };
+
+	for (auto It{ Resolutions.CreateIterator() }; It; ++It)
+	{
+		if (It->Key.ItemData == ItemDataKey)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UEquipmentAssetRegistrySubsystem::InvalidateResolutionsForContext(FName ContextKey)
+{
+	for (auto It{ Resolutions.CreateIterator() }; It; ++It)
+	{
+		if (It->Key.ContextKey == ContextKey)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UEquipmentAssetRegistrySubsystem::InvalidateAllResolutions()
+{
+	Resolutions.Reset();
+}
+
+
+TSubclassOf<UEquipment> UEquipmentAssetRegistrySubsystem::FindEquipmentClass(const UItemData* ItemData) const
+{
+	const auto* Entry{ Entries.Find(ItemData) };
+
+	return Entry ? Entry->EquipmentClass.Get() : nullptr;
+}
+
+TSharedPtr<FStreamableHandle> UEquipmentAssetRegistrySubsystem::RequestEquipmentClass(const UItemData* ItemData, FStreamableDelegate OnLoaded)
+{
+	// Register it if it was not scanned
+
+	if (!RegisterEquipmentItem(ItemData))
+	{
+		return nullptr;
+	}
+
+	auto& Entry{ Entries.FindChecked(ItemData) };
+
+	TouchEntry(Entry);
+	PinEntry(ItemData, Entry, FStreamableManager::DefaultAsyncLoadPriority);
+
+	// Complete immediately if it is already loaded
+
+	if (Entry.EquipmentClass.Get())
+	{
+		OnLoaded.ExecuteIfBound();
+		return nullptr;
+	}
+
+	// Request separately from the pin so that each caller can cancel its own request
+
+	return UAssetManager::GetStreamableManager().RequestAsyncLoad(Entry.EquipmentClass.ToSoftObjectPath(), MoveTemp(OnLoaded));
+}
+
+void UEquipmentAssetRegistrySubsystem::ReleaseEquipmentClass(const UItemData* ItemData)
+{
+	auto* Entry{ Entries.Find(ItemData) };
+
+	if (!Entry || (Entry->Residency == EEquipmentResidency::AlwaysResident) || (Entry->LiveRefCount > 0))
+	{
+		return;
+	}
+
+	UnpinEntry(*Entry);
+}
+
+void UEquipmentAssetRegistrySubsystem::AcquireEquipment(const UItemData* ItemData)
+{
+	if (!RegisterEquipmentItem(ItemData))
+	{
+		return;
+	}
+
+	auto& Entry{ Entries.FindChecked(ItemData) };
+
+	Entry.LiveRefCount++;
+
+	TouchEntry(Entry);
+
+	// Count as a hit only if all assets were already held
+
+	if (Entry.IsPinned())
+	{
+		NumHits++;
+	}
+	else
+	{
+		NumMisses++;
+
+		PinEntry(ItemData, Entry, FStreamableManager::DefaultAsyncLoadPriority);
+	}
+}
+
+void UEquipmentAssetRegistrySubsystem::ReleaseEquipment(const UItemData* ItemData)
+{
+	auto* Entry{ Entries.Find(ItemData) };
+
+	if (!Entry || (Entry->LiveRefCount <= 0))
+	{
+		return;
+	}
+
+	Entry->LiveRefCount--;
+
+	TouchEntry(*Entry);
+
+	if (Entry->LiveRefCount == 0)
+	{
+		EnforceBudget();
+	}
+}
+
+FEquipmentPrewarmHandle UEquipmentAssetRegistrySubsystem::PrewarmEquipment(const UItemData* ItemData, EEquipmentPrewarmPriority Priority)
+{
+	if (!RegisterEquipmentItem(ItemData))
+	{
+		return FEquipmentPrewarmHandle();
+	}
+
+	auto& Entry{ Entries.FindChecked(ItemData) };
+
+	TouchEntry(Entry);
+
+	// Nothing to cancel if it is already loaded
+
+	if (Entry.IsPinned())
+	{
+		return FEquipmentPrewarmHandle();
+	}
+
+	const auto RequestId{ ++LastPrewarmRequestId };
+
+	Entry.PendingPrewarmRequests.Add(RequestId);
+
+	PinEntry(ItemData, Entry, GetAsyncLoadPriority(Priority));
+
+	return FEquipmentPrewarmHandle(ItemData, RequestId);
+}
+
+void UEquipmentAssetRegistrySubsystem::CancelPrewarm(const FEquipmentPrewarmHandle& Handle)
+{
+	auto* Entry{ Handle.IsValid() ? Entries.Find(Handle.ItemData.Get()) : nullptr };
+
+	if (!Entry || (Entry->PendingPrewarmRequests.Remove(Handle.RequestId) == 0))
+	{
+		return;
+	}
+
+	// Stop loading only if no one else needs the assets
+
+	const auto bNeeded
+	{
+		!Entry->PendingPrewarmRequests.IsEmpty() || (Entry->LiveRefCount > 0) || (Entry->Residency == EEquipmentResidency::AlwaysResident)
+	};
+
+	if (!bNeeded && !Entry->IsPinned())
+	{
+		UnpinEntry(*Entry);
+	}
+}
+
+bool UEquipmentAssetRegistrySubsystem::IsEquipmentPrewarmed(const UItemData* ItemData) const
+{
+	const auto* Entry{ Entries.Find(ItemData) };
+
+	return Entry && Entry->IsPinned();
+}
+
+
+void UEquipmentAssetRegistrySubsystem::EnforceBudget()
+{
+	const auto BudgetBytes{ GetBudgetBytes() };
+
+	// Suspend if the running total fits the budget
+
+	if ((BudgetBytes <= 0) || (PinnedResourceBytes <= BudgetBytes))
+	{
+		return;
+	}
+
+	// Collect entries that can be evicted
+
+	struct FEvictionCandidate
+	{
+		TObjectPtr<const UItemData> ItemData;
+		uint64 LastUsedSerial;
+		int64 ResourceBytes;
+	};
+
+	TArray<FEvictionCandidate> Candidates;
+
+	for (const auto& KVP : Entries)
+	{
+		const auto& Entry{ KVP.Value };
+
+		// Never evict assets that a prewarm request is still waiting for
+
+		if ((Entry.ResourceBytes > 0) && (Entry.LiveRefCount == 0) && (Entry.Residency != EEquipmentResidency::AlwaysResident) && Entry.PendingPrewarmRequests.IsEmpty())
+		{
+			Candidates.Add({ KVP.Key, Entry.LastUsedSerial, Entry.ResourceBytes });
+		}
+	}
+
+	// Evict least recently used first
+
+	Candidates.Sort([](const FEvictionCandidate& A, const FEvictionCandidate& B) { return A.LastUsedSerial < B.LastUsedSerial; });
+
+	for (const auto& Candidate : Candidates)
+	{
+		if (PinnedResourceBytes <= BudgetBytes)
+		{
+			break;
+		}
+
+		UnpinEntry(Entries.FindChecked(Candidate.ItemData));
+
+		NumEvictions++;
+
+		UE_LOG(LogGameCore_Equipment, Verbose, TEXT("Evicted equipment assets of [%s] (%lld bytes)"), *GetNameSafe(Candidate.ItemData), Candidate.ResourceBytes);
+	}
+}
+
+
+TSharedPtr<FStreamableHandle> UEquipmentAssetRegistrySubsystem::PinEntry(const UItemData* ItemData, FEquipmentAssetRegistryEntry& Entry, TAsyncLoadPriority Priority)
+{
+	if (Entry.EquipmentClass.IsNull())
+	{
+		return Entry.PinHandle;
+	}
+
+	if (!Entry.PinHandle.IsValid())
+	{
+		Entry.PinPriority = Priority;
+		Entry.PinHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			Entry.EquipmentClass.ToSoftObjectPath()
+			, FStreamableDelegate::CreateUObject(this, &ThisClass::HandleEquipmentClassPinned, TWeakObjectPtr<const UItemData>(ItemData))
+			, Priority);
+	}
+	else if (Priority > Entry.PinPriority)
+	{
+		RaisePinPriority(ItemData, Entry, Priority);
+	}
+
+	return Entry.PinHandle;
+}
+
+void UEquipmentAssetRegistrySubsystem::RaisePinPriority(const UItemData* ItemData, FEquipmentAssetRegistryEntry& Entry, TAsyncLoadPriority Priority)
+{
+	Entry.PinPriority = Priority;
+
+	// Request the loads in flight again at the higher priority before cancelling the old requests so that they are not unloaded
+
+	auto& StreamableManager{ UAssetManager::GetStreamableManager() };
+
+	const TWeakObjectPtr<const UItemData> WeakItemData{ ItemData };
+
+	if (Entry.PinHandle.IsValid() && Entry.PinHandle->IsLoadingInProgress())
+	{
+		auto OldHandle{ Entry.PinHandle };
+
+		Entry.PinHandle = StreamableManager.RequestAsyncLoad(
+			Entry.EquipmentClass.ToSoftObjectPath()
+			, FStreamableDelegate::CreateUObject(this, &ThisClass::HandleEquipmentClassPinned, WeakItemData)
+			, Priority);
+
+		OldHandle->CancelHandle();
+	}
+
+	if (Entry.FragmentAssetsHandle.IsValid() && Entry.FragmentAssetsHandle->IsLoadingInProgress())
+	{
+		auto OldHandle{ Entry.FragmentAssetsHandle };
+
+		TArray<FSoftObjectPath> AssetsToLoad;
+		OldHandle->GetRequestedAssets(AssetsToLoad);
+
+		Entry.FragmentAssetsHandle = StreamableManager.RequestAsyncLoad(
+			AssetsToLoad
+			, FStreamableDelegate::CreateUObject(this, &ThisClass::HandleFragmentAssetsPinned, WeakItemData)
+			, Priority);
+
+		OldHandle->CancelHandle();
+	}
+}
+
+void UEquipmentAssetRegistrySubsystem::UnpinEntry(FEquipmentAssetRegistryEntry& Entry)
+{
+	for (auto* Handle : { &Entry.PinHandle, &Entry.FragmentAssetsHandle })
+	{
+		if (Handle->IsValid())
+		{
+			if ((*Handle)->IsLoadingInProgress())
+			{
+				(*Handle)->CancelHandle();
+			}
+			else
+			{
+				(*Handle)->ReleaseHandle();
+			}
+
+			Handle->Reset();
+		}
+	}
+
+	Entry.PendingPrewarmRequests.Reset();
+
+	PinnedResourceBytes -= Entry.ResourceBytes;
+	Entry.ResourceBytes = 0;
+}
+
+void UEquipmentAssetRegistrySubsystem::HandleEquipmentClassPinned(TWeakObjectPtr<const UItemData> WeakItemData)
+{
+	auto* Entry{ Entries.Find(WeakItemData.Get()) };
+
+	if (!Entry || Entry->FragmentAssetsHandle.IsValid())
+	{
+		return;
+	}
+
+	// Also pin the assets referenced by the fragments that are executed on this machine
+
+	constexpr auto DedicatedServerContext{ EEquipmentNetContext::Authority | EEquipmentNetContext::DedicatedServer };
+
+	TArray<FSoftObjectPath> AssetsToLoad;
+
+	if (const auto* Class{ Entry->EquipmentClass.Get() })
+	{
+		for (const auto& Fragment : Class->GetDefaultObject<UEquipment>()->GetFragments())
+		{
+			if (Fragment && (!bDedicatedServer || ShouldExecuteEquipmentFragment(Fragment->GetNetExecutionPolicy(), DedicatedServerContext)))
+			{
+				Fragment->GetAssetsToLoad(AssetsToLoad);
+			}
+		}
+	}
+
+	if (!AssetsToLoad.IsEmpty())
+	{
+		Entry->FragmentAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			AssetsToLoad
+			, FStreamableDelegate::CreateUObject(this, &ThisClass::HandleFragmentAssetsPinned, WeakItemData)
+			, Entry->PinPriority);
+
+		// The delegate may have been called before the handle was stored
+
+		if (!Entry->FragmentAssetsHandle.IsValid() || !Entry->FragmentAssetsHandle->HasLoadCompleted())
+		{
+			return;
+		}
+	}
+
+	HandlePinCompleted(*Entry);
+}
+
+void UEquipmentAssetRegistrySubsystem::HandleFragmentAssetsPinned(TWeakObjectPtr<const UItemData> WeakItemData)
+{
+	auto* Entry{ Entries.Find(WeakItemData.Get()) };
+
+	if (!Entry || !Entry->FragmentAssetsHandle.IsValid())
+	{
+		return;
+	}
+
+	HandlePinCompleted(*Entry);
+}
+
+void UEquipmentAssetRegistrySubsystem::HandlePinCompleted(FEquipmentAssetRegistryEntry& Entry)
+{
+	// Prewarm requests have nothing to cancel anymore
+
+	Entry.PendingPrewarmRequests.Reset();
+
+	UpdateEntryResourceBytes(Entry);
+
+	EnforceBudget();
+}
+
+void UEquipmentAssetRegistrySubsystem::UpdateEntryResourceBytes(FEquipmentAssetRegistryEntry& Entry)
+{
+	PinnedResourceBytes -= Entry.ResourceBytes;
+
+	Entry.ResourceBytes = GetEntryResourceBytes(Entry);
+
+	PinnedResourceBytes += Entry.ResourceBytes;
+}
+
+void UEquipmentAssetRegistrySubsystem::TouchEntry(FEquipmentAssetRegistryEntry& Entry)
+{
+	Entry.LastUsedSerial = ++UseSerial;
+}
+
+
+TAsyncLoadPriority UEquipmentAssetRegistrySubsystem::GetAsyncLoadPriority(EEquipmentPrewarmPriority Priority)
+{
+	switch (Priority)
+	{
+	case EEquipmentPrewarmPriority::Background:
+		return FStreamableManager::DefaultAsyncLoadPriority - 1;
+
+	case EEquipmentPrewarmPriority::High:
+		return FStreamableManager::AsyncLoadHighPriority;
+
+	default:
+		return FStreamableManager::DefaultAsyncLoadPriority;
+	}
+}
+
+
+int64 UEquipmentAssetRegistrySubsystem::GetEntryResourceBytes(const FEquipmentAssetRegistryEntry& Entry) const
+{
+	int64 ResourceBytes{ 0 };
+
+	// Estimate the size of the class and the CDOs that are kept loaded by the pin
+
+	if (const auto* Class{ Entry.EquipmentClass.Get() })
+	{
+		ResourceBytes += Class->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+
+		if (const auto* CDO{ Class->GetDefaultObject<UEquipment>() })
+		{
+			ResourceBytes += CDO->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+
+			for (const auto& Fragment : CDO->GetFragments())
+			{
+				if (Fragment)
+				{
+					ResourceBytes += Fragment->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+				}
+			}
+		}
+	}
+
+	// Add the size of the assets referenced by the fragments
+
+	if (Entry.FragmentAssetsHandle.IsValid())
+	{
+		TArray<UObject*> LoadedAssets;
+		Entry.FragmentAssetsHandle->GetLoadedAssets(LoadedAssets);
+
+		for (const auto* Asset : LoadedAssets)
+		{
+			if (Asset)
+			{
+				ResourceBytes += Asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+			}
+		}
+	}
+
+	return ResourceBytes;
+}
+
+int64 UEquipmentAssetRegistrySubsystem::GetBudgetBytes() const
+{
+	return static_cast<int64>(GetDefault<UGEEquipDeveloperSettings>()->AssetCacheBudgetMB) * 1024 * 1024;
+}
+
+
+FEquipmentAssetRegistryStats UEquipmentAssetRegistrySubsystem::GetStats() const
+{
+	FEquipmentAssetRegistryStats Stats;
+	Stats.BudgetBytes = GetBudgetBytes();
+	Stats.NumHits = NumHits;
+	Stats.NumMisses = NumMisses;
+	Stats.NumEvictions = NumEvictions;
+	Stats.PinnedResourceBytes = PinnedResourceBytes;
+
+	for (const auto& KVP : Entries)
+	{
+		const auto& Entry{ KVP.Value };
+
+		Stats.NumRegistered++;
+
+		if (Entry.Residency == EEquipmentResidency::AlwaysResident)
+		{
+			Stats.NumAlwaysResident++;
+		}
+
+		if (Entry.LiveRefCount > 0)
+		{
+			Stats.NumInUse++;
+		}
+
+		if (Entry.IsPinned())
+		{
+			Stats.NumPinned++;
+		}
+	}
+
+	return Stats;
+}
+
+
+UEquipmentAssetRegistrySubsystem* UEquipmentAssetRegistrySubsystem::Get(const UObject* WorldContextObject)
+{
+	if (auto* World{ GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) })
+	{
+		if (auto* GameInstance{ World->GetGameInstance() })
+		{
+			return GameInstance->GetSubsystem<UEquipmentAssetRegistrySubsystem>();
+		}
+	}
+
+	return nullptr;
+}
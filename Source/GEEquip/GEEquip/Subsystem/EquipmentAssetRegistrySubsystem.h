@@ -0,0 +1,425 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/GameInstanceSubsystem.h"
+
+#include "Item/ItemInfo_Equipment.h"
+
+#include "Engine/StreamableManager.h"
+
+#include "EquipmentAssetRegistrySubsystem.generated.h"
+
+class UItemData;
+class UEquipment;
+class UWorld;
+class UEquipmentCatalog;
+struct FEquipmentCatalogEntry;
+
+
+/**
+ * Load priority of prewarming equipment assets
+ */
+UENUM(BlueprintType)
+enum class EEquipmentPrewarmPriority : uint8
+{
+	// Lower than the default priority so that it does not compete with gameplay streaming
+	Background,
+
+	// Same as the default priority
+	Normal,
+
+	// Same as the high priority, e.g. when the item is about to be equipped
+	High
+};
+
+
+/**
+ * Handle to cancel a prewarm request
+ */
+USTRUCT(BlueprintType)
+struct FEquipmentPrewarmHandle
+{
+	GENERATED_BODY()
+public:
+	FEquipmentPrewarmHandle() {}
+	FEquipmentPrewarmHandle(const UItemData* InItemData, uint32 InRequestId)
+		: ItemData(InItemData), RequestId(InRequestId)
+	{}
+
+public:
+	UPROPERTY()
+	TWeakObjectPtr<const UItemData> ItemData{ nullptr };
+
+	UPROPERTY()
+	uint32 RequestId{ 0 };
+
+public:
+	/**
+	 * Returns whether the request was still loading when it was made
+	 */
+	bool IsValid() const { return RequestId != 0; }
+
+};
+
+
+/**
+ * Equipment item registered in the equipment asset registry
+ */
+USTRUCT()
+struct FEquipmentAssetRegistryEntry
+{
+	GENERATED_BODY()
+public:
+	FEquipmentAssetRegistryEntry() {}
+
+public:
+	UPROPERTY()
+	TSoftClassPtr<UEquipment> EquipmentClass;
+
+	UPROPERTY()
+	EEquipmentResidency Residency{ EEquipmentResidency::OnDemand };
+
+	//
+	// Handle that keeps the Equipment class and its fragment CDOs loaded
+	//
+	TSharedPtr<FStreamableHandle> PinHandle;
+
+	//
+	// Handle that keeps the assets referenced by the fragments loaded
+	//
+	TSharedPtr<FStreamableHandle> FragmentAssetsHandle;
+
+	//
+	// Highest priority requested for the loads of the pin in flight
+	//
+	TAsyncLoadPriority PinPriority{ 0 };
+
+	//
+	// Number of active equipments currently using this item
+	//
+	int32 LiveRefCount{ 0 };
+
+	//
+	// Serial number of the last time this item was used, for least recently used eviction
+	//
+	uint64 LastUsedSerial{ 0 };
+
+	//
+	// Estimated size of the assets held by the pin, computed once when the pin completes
+	//
+	int64 ResourceBytes{ 0 };
+
+	//
+	// Id of prewarm requests waiting for the assets to be loaded
+	// 
+	// Tips:
+	//	Cleared when the pin completes since there is nothing to cancel anymore.
+	//
+	TArray<uint32> PendingPrewarmRequests;
+
+public:
+	bool IsPinned() const;
+
+};
+
+
+/**
+ * Key of the cached resolution of an item for a context
+ */
+struct FEquipmentResolutionKey
+{
+public:
+	FEquipmentResolutionKey() {}
+	FEquipmentResolutionKey(const UItemData* InItemData, FName InContextKey)
+		: ItemData(InItemData), ContextKey(InContextKey)
+	{}
+
+public:
+	TObjectKey<UItemData> ItemData;
+
+	FName ContextKey;
+
+public:
+	bool operator==(const FEquipmentResolutionKey& Other) const { return (ItemData == Other.ItemData) && (ContextKey == Other.ContextKey); }
+
+	friend uint32 GetTypeHash(const FEquipmentResolutionKey& Key) { return HashCombine(GetTypeHash(Key.ItemData), GetTypeHash(Key.ContextKey)); }
+
+};
+
+
+/**
+ * Cached result of resolving the equipment info and Equipment class of an item
+ */
+struct FEquipmentResolution
+{
+public:
+	FEquipmentResolution() {}
+
+public:
+	TWeakObjectPtr<const UItemInfo_Equipment> EquipmentInfo{ nullptr };
+
+	TWeakObjectPtr<UClass> EquipmentClass{ nullptr };
+
+};
+
+
+/**
+ * Statistics of the equipment asset registry
+ */
+USTRUCT(BlueprintType)
+struct FEquipmentAssetRegistryStats
+{
+	GENERATED_BODY()
+public:
+	FEquipmentAssetRegistryStats() {}
+
+public:
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumRegistered{ 0 };
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumPinned{ 0 };
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumAlwaysResident{ 0 };
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumInUse{ 0 };
+
+	//
+	// Estimated size of the Equipment classes, CDOs, fragment CDOs and fragment assets held by the registry
+	//
+	UPROPERTY(BlueprintReadOnly)
+	int64 PinnedResourceBytes{ 0 };
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 BudgetBytes{ 0 };
+
+	//
+	// Number of acquires whose assets were already held by the registry
+	//
+	UPROPERTY(BlueprintReadOnly)
+	int64 NumHits{ 0 };
+
+	//
+	// Number of acquires whose assets had to be loaded
+	//
+	UPROPERTY(BlueprintReadOnly)
+	int64 NumMisses{ 0 };
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 NumEvictions{ 0 };
+
+public:
+	FString ToString() const;
+
+};
+
+
+/**
+ * Subsystem that registers all equipment items and keeps their Equipment classes loaded by residency
+ * 
+ * Tips:
+ *	Items with AlwaysResident are loaded when scanned and kept for the lifetime of the game instance,
+ *	so that adding them never loads anything on the game thread.
+ *	Items with OnDemand are only registered and loaded with RequestEquipmentClass() or PrewarmEquipment().
+ */
+UCLASS()
+class GEEQUIP_API UEquipmentAssetRegistrySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+public:
+	UEquipmentAssetRegistrySubsystem() {}
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+
+protected:
+	//
+	// Registered equipment items
+	//
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<const UItemData>, FEquipmentAssetRegistryEntry> Entries;
+
+	//
+	// Catalog of equipment items baked at cook time
+	//
+	UPROPERTY(Transient)
+	TObjectPtr<const UEquipmentCatalog> Catalog{ nullptr };
+
+	//
+	// Handle to load item data being scanned
+	//
+	TSharedPtr<FStreamableHandle> ScanHandle;
+
+	//
+	// Item data assets that have already been scanned
+	//
+	TSet<FPrimaryAssetId> ScannedAssetIds;
+
+	FDelegateHandle PostLoadMapHandle;
+
+	//
+	// Counter used to order entries by last use
+	//
+	uint64 UseSerial{ 0 };
+
+	//
+	// Sum of the estimated sizes of all pinned entries
+	//
+	int64 PinnedResourceBytes{ 0 };
+
+	//
+	// Whether this is a dedicated server that never executes client-only fragments
+	//
+	bool bDedicatedServer{ false };
+
+	int64 NumHits{ 0 };
+	int64 NumMisses{ 0 };
+	int64 NumEvictions{ 0 };
+
+	uint32 LastPrewarmRequestId{ 0 };
+
+	//
+	// Cached equipment info and Equipment class for each item and context
+	//
+	TMap<FEquipmentResolutionKey, FEquipmentResolution> Resolutions;
+
+public:
+	/**
+	 * Load all item data of the asset types in the settings and register the equipment items that are not registered yet
+	 */
+	void ScanEquipmentItems();
+
+	/**
+	 * Register the equipment item and pin it if it is always resident
+	 * 
+	 * Tips:
+	 *	Returns false if the item data has no equipment info
+	 */
+	bool RegisterEquipmentItem(const UItemData* ItemData);
+
+	/**
+	 * Returns the entry baked in the catalog for the item or nullptr if it is not baked
+	 * 
+	 * Tips:
+	 *	Always returns nullptr in uncooked builds, e.g. in the editor and PIE.
+	 */
+	const FEquipmentCatalogEntry* FindCatalogEntry(const UItemData* ItemData) const;
+
+	/**
+	 * Resolve the equipment info and Equipment class of the item for the context and cache the result
+	 * 
+	 * Tips:
+	 *	Use ContextKey to separate results that depend on other systems, e.g. the skin id,
+	 *	and invalidate the cache when the result for the item or context may change.
+	 *	Returns false if the item has no equipment info or Equipment class.
+	 */
+	bool ResolveEquipment(const UItemData* ItemData, FName ContextKey, const UItemInfo_Equipment*& OutEquipmentInfo, TSubclassOf<UEquipment>& OutEquipmentClass);
+
+	/**
+	 * Discard the cached resolutions of the item for all contexts
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	void InvalidateResolutionsForItem(const UItemData* ItemData);
+
+	/**
+	 * Discard the cached resolutions of all items for the context, e.g. when the skin is changed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	void InvalidateResolutionsForContext(FName ContextKey);
+
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	void InvalidateAllResolutions();
+
+	/**
+	 * Returns the Equipment class of the item if it is loaded without loading anything
+	 */
+	TSubclassOf<UEquipment> FindEquipmentClass(const UItemData* ItemData) const;
+
+	/**
+	 * Load and pin the Equipment class of the item asynchronously
+	 *
+	 * Tips:
+	 *	OnLoaded is called immediately if it is already pinned
+	 */
+	TSharedPtr<FStreamableHandle> RequestEquipmentClass(const UItemData* ItemData, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	/**
+	 * Unpin the Equipment class of the item so that it can be unloaded
+	 * 
+	 * Tips:
+	 *	Always resident items and items in use are never released
+	 */
+	void ReleaseEquipmentClass(const UItemData* ItemData);
+
+	/**
+	 * Mark the item as used by an active equipment and pin its assets
+	 */
+	void AcquireEquipment(const UItemData* ItemData);
+
+	/**
+	 * Mark the item as no longer used by an active equipment and evict unused assets if the budget is exceeded
+	 */
+	void ReleaseEquipment(const UItemData* ItemData);
+
+	/**
+	 * Load the Equipment class and the assets referenced by its fragments ahead of time, 
+	 * e.g. when the item enters the inventory, a pickup comes nearby or a loadout screen opens.
+	 * 
+	 * Tips:
+	 *	Prewarmed assets are kept in the cache until evicted by the budget.
+	 *	Returns an invalid handle if the assets are already loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	FEquipmentPrewarmHandle PrewarmEquipment(const UItemData* ItemData, EEquipmentPrewarmPriority Priority = EEquipmentPrewarmPriority::Background);
+
+	/**
+	 * Cancel the prewarm request and stop loading if no other request or active equipment needs the assets
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	void CancelPrewarm(const FEquipmentPrewarmHandle& Handle);
+
+	/**
+	 * Returns whether the assets of the item are loaded and held by the registry
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Equipment")
+	bool IsEquipmentPrewarmed(const UItemData* ItemData) const;
+
+	/**
+	 * Evict assets of unused items in least recently used order until the estimated memory fits the budget
+	 */
+	void EnforceBudget();
+
+	/**
+	 * Returns current statistics including the memory held by the registry
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	FEquipmentAssetRegistryStats GetStats() const;
+
+protected:
+	void HandleItemDataScanned(TArray<FPrimaryAssetId> AssetIds);
+	void HandlePostLoadMap(UWorld* LoadedWorld);
+
+	TSharedPtr<FStreamableHandle> PinEntry(const UItemData* ItemData, FEquipmentAssetRegistryEntry& Entry, TAsyncLoadPriority Priority);
+	void UnpinEntry(FEquipmentAssetRegistryEntry& Entry);
+	void RaisePinPriority(const UItemData* ItemData, FEquipmentAssetRegistryEntry& Entry, TAsyncLoadPriority Priority);
+	void HandleEquipmentClassPinned(TWeakObjectPtr<const UItemData> WeakItemData);
+	void HandleFragmentAssetsPinned(TWeakObjectPtr<const UItemData> WeakItemData);
+	void HandlePinCompleted(FEquipmentAssetRegistryEntry& Entry);
+	void UpdateEntryResourceBytes(FEquipmentAssetRegistryEntry& Entry);
+	void TouchEntry(FEquipmentAssetRegistryEntry& Entry);
+
+	static TAsyncLoadPriority GetAsyncLoadPriority(EEquipmentPrewarmPriority Priority);
+
+	int64 GetEntryResourceBytes(const FEquipmentAssetRegistryEntry& Entry) const;
+	int64 GetBudgetBytes() const;
+
+
+public:
+	static UEquipmentAssetRegistrySubsystem* Get(const UObject* WorldContextObject);
+
+};
@@ -0,0 +1,151 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "EquipmentMeshPoolSubsystem.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentMeshPoolSubsystem)
+
+
+static TAutoConsoleVariable<int32> CVarEquipmentMeshPoolMaxPerOwner(
+	TEXT("GEEquip.MeshPool.MaxPerOwner"),
+	8,
+	TEXT("Maximum number of pooled equipment mesh components kept for each owner actor."),
+	ECVF_Default);
+
+
+bool UEquipmentMeshPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE);
+}
+
+void UEquipmentMeshPoolSubsystem::Deinitialize()
+{
+	PooledComponents.Empty();
+
+	Super::Deinitialize();
+}
+
+
+USkeletalMeshComponent* UEquipmentMeshPoolSubsystem::AcquireMeshComponent(AActor* Owner)
+{
+	check(Owner);
+
+	// Check out from pool
+
+	if (auto* Pool{ PooledComponents.Find(Owner) })
+	{
+		while (!Pool->IsEmpty())
+		{
+			if (auto* Component{ Pool->Pop().Get() })
+			{
+				return Component;
+			}
+		}
+	}
+
+	// Create new one if pool is empty
+
+	return CreateMeshComponent(Owner);
+}
+
+void UEquipmentMeshPoolSubsystem::ReleaseMeshComponent(USkeletalMeshComponent* Component)
+{
+	if (!::IsValid(Component))
+	{
+		return;
+	}
+
+	auto* Owner{ Component->GetOwner() };
+
+	// Destroy it if owner is being destroyed or pool is full
+
+	if (!::IsValid(Owner) || Owner->IsActorBeingDestroyed())
+	{
+		Component->DestroyComponent();
+		return;
+	}
+
+	auto& Pool{ PooledComponents.FindOrAdd(Owner) };
+
+	if (Pool.Num() >= CVarEquipmentMeshPoolMaxPerOwner.GetValueOnGameThread())
+	{
+		Component->DestroyComponent();
+		return;
+	}
+
+	// Check in to pool
+
+	if (Pool.IsEmpty())
+	{
+		Owner->OnEndPlay.AddUniqueDynamic(this, &ThisClass::HandleOwnerEndPlay);
+	}
+
+	ResetMeshComponent(Component);
+
+	Pool.Add(Component);
+}
+
+void UEquipmentMeshPoolSubsystem::ReserveMeshComponents(AActor* Owner, int32 Count)
+{
+	check(Owner);
+
+	auto& Pool{ PooledComponents.FindOrAdd(Owner) };
+
+	Count = FMath::Min(Count, CVarEquipmentMeshPoolMaxPerOwner.GetValueOnGameThread());
+
+	if (Pool.Num() < Count)
+	{
+		Owner->OnEndPlay.AddUniqueDynamic(this, &ThisClass::HandleOwnerEndPlay);
+	}
+
+	while (Pool.Num() < Count)
+	{
+		auto* Component{ CreateMeshComponent(Owner) };
+
+		ResetMeshComponent(Component);
+
+		Pool.Add(Component);
+	}
+}
+
+
+USkeletalMeshComponent* UEquipmentMeshPoolSubsystem::CreateMeshComponent(AActor* Owner) const
+{
+	auto* NewMesh{ NewObject<USkeletalMeshComponent>(Owner) };
+	NewMesh->RegisterComponent();
+
+	return NewMesh;
+}
+
+void UEquipmentMeshPoolSubsystem::ResetMeshComponent(USkeletalMeshComponent* Component) const
+{
+	// Clear mesh and anim class so that pooled components do not keep evicted equipment assets resident
+
+	Component->SetHiddenInGame(true);
+	Component->SetComponentTickEnabled(false);
+	Component->SetLeaderPoseComponent(nullptr);
+	Component->SetAnimInstanceClass(nullptr);
+	Component->SetSkeletalMesh(nullptr);
+	Component->EmptyOverrideMaterials();
+	Component->DetachFromComponent(FDetachmentTransformRules::KeepRelativeTransform);
+}
+
+void UEquipmentMeshPoolSubsystem::HandleOwnerEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	PooledComponents.Remove(Actor);
+}
+
+
+UEquipmentMeshPoolSubsystem* UEquipmentMeshPoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (auto* World{ GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) })
+	{
+		return World->GetSubsystem<UEquipmentMeshPoolSubsystem>();
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,69 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "EquipmentMeshPoolSubsystem.generated.h"
+
+class USkeletalMeshComponent;
+class AActor;
+
+
+/**
+ * Subsystem that pools registered and hidden skeletal mesh components for each owner actor
+ *
+ * Tips:
+ *	Components are outered to the owner actor, so they can only be reused by the same owner.
+ *	Released components are cleared of their mesh, anim class and material overrides so that
+ *	the pool never keeps equipment assets resident after the asset registry has evicted them.
+ *	Acquired components are registered and hidden, so the caller should set up everything it needs.
+ */
+UCLASS()
+class GEEQUIP_API UEquipmentMeshPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UEquipmentMeshPoolSubsystem() {}
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void Deinitialize() override;
+
+
+protected:
+	//
+	// List of pooled components for each owner actor
+	//
+	TMap<TObjectKey<AActor>, TArray<TWeakObjectPtr<USkeletalMeshComponent>>> PooledComponents;
+
+public:
+	/**
+	 * Check out a pooled component of the owner, or create and register a new one if the pool is empty
+	 */
+	USkeletalMeshComponent* AcquireMeshComponent(AActor* Owner);
+
+	/**
+	 * Check in the component to the pool of its owner, or destroy it if the pool is full
+	 */
+	void ReleaseMeshComponent(USkeletalMeshComponent* Component);
+
+	/**
+	 * Create components in advance so that the pool of the owner has at least the specified number
+	 */
+	void ReserveMeshComponents(AActor* Owner, int32 Count);
+
+protected:
+	USkeletalMeshComponent* CreateMeshComponent(AActor* Owner) const;
+	void ResetMeshComponent(USkeletalMeshComponent* Component) const;
+
+	UFUNCTION()
+	void HandleOwnerEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+
+public:
+	static UEquipmentMeshPoolSubsystem* Get(const UObject* WorldContextObject);
+
+};
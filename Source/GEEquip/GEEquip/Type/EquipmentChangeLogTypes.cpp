@@ -0,0 +1,45 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "EquipmentChangeLogTypes.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentChangeLogTypes)
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// FEquipmentChangeLog
+
+void FEquipmentChangeLog::Add(EEquipmentChangeLogType Type, const FActiveEquipmentHandle& Handle, const FGameplayTag& SlotTag)
+{
+	++Version;
+
+	// Grow until the capacity is reached and then overwrite the oldest record
+
+	const auto Index{ static_cast<int32>((Version - 1) % MaxRecords) };
+
+	auto& Record{ Records.IsValidIndex(Index) ? Records[Index] : Records.AddDefaulted_GetRef() };
+	Record.Version = Version;
+	Record.Type = Type;
+	Record.Handle = Handle;
+	Record.SlotTag = SlotTag;
+}
+
+bool FEquipmentChangeLog::GetChangesSince(int64 SinceVersion, TArray<FEquipmentChangeRecord>& OutRecords) const
+{
+	// Suspend if the version is newer than the log or older than the oldest record
+
+	const auto OldestVersion{ Version - Records.Num() };
+
+	if ((SinceVersion > Version) || (SinceVersion < OldestVersion))
+	{
+		return false;
+	}
+
+	OutRecords.Reserve(OutRecords.Num() + static_cast<int32>(Version - SinceVersion));
+
+	for (auto RecordVersion{ SinceVersion + 1 }; RecordVersion <= Version; ++RecordVersion)
+	{
+		OutRecords.Add(Records[static_cast<int32>((RecordVersion - 1) % MaxRecords)]);
+	}
+
+	return true;
+}
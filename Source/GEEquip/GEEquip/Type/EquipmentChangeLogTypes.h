@@ -0,0 +1,95 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Equipment/ActiveEquipmentHandle.h"
+
+#include "GameplayTagContainer.h"
+
+#include "EquipmentChangeLogTypes.generated.h"
+
+
+/**
+ * Type of change recorded in the change log of the equipment container
+ */
+UENUM(BlueprintType)
+enum class EEquipmentChangeLogType : uint8
+{
+	Added,
+	Removed,
+	Equipped,
+	Unequipped
+};
+
+
+/**
+ * Single change recorded in the change log of the equipment container
+ */
+USTRUCT(BlueprintType)
+struct GEEQUIP_API FEquipmentChangeRecord
+{
+	GENERATED_BODY()
+public:
+	FEquipmentChangeRecord() {}
+
+public:
+	//
+	// Version of the container after this change
+	//
+	UPROPERTY(BlueprintReadOnly)
+	int64 Version{ 0 };
+
+	UPROPERTY(BlueprintReadOnly)
+	EEquipmentChangeLogType Type{ EEquipmentChangeLogType::Added };
+
+	UPROPERTY(BlueprintReadOnly)
+	FActiveEquipmentHandle Handle;
+
+	UPROPERTY(BlueprintReadOnly)
+	FGameplayTag SlotTag;
+
+};
+
+
+/**
+ * Bounded ring buffer of changes with a monotonically increasing version
+ * 
+ * Tips:
+ *	Consumers keep the last version they applied and ask for the changes since it.
+ *	If the changes have been overwritten, they must re-read all slots.
+ */
+struct GEEQUIP_API FEquipmentChangeLog
+{
+public:
+	FEquipmentChangeLog() {}
+
+	//
+	// Maximum number of changes kept in the log
+	//
+	static constexpr int32 MaxRecords{ 64 };
+
+private:
+	//
+	// Records indexed by (Version - 1) % MaxRecords
+	//
+	TArray<FEquipmentChangeRecord> Records;
+
+	//
+	// Version of the latest change (0 if nothing has changed)
+	//
+	int64 Version{ 0 };
+
+public:
+	void Add(EEquipmentChangeLogType Type, const FActiveEquipmentHandle& Handle, const FGameplayTag& SlotTag);
+
+	int64 GetVersion() const { return Version; }
+
+	/**
+	 * Get the changes after the version in order
+	 * 
+	 * Tips:
+	 *	Returns false if the changes have been overwritten or the version is unknown, and a full resync is required.
+	 */
+	bool GetChangesSince(int64 SinceVersion, TArray<FEquipmentChangeRecord>& OutRecords) const;
+
+};
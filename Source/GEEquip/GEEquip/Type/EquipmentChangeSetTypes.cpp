@@ -0,0 +1,68 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "EquipmentChangeSetTypes.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentChangeSetTypes)
+
+
+void FEquipmentChangeSet::AddEquipmentItem(const FGameplayTag& SlotTag, const UItemData* ItemData, bool bEquipImmediately, FName ResolveContext, TSubclassOf<UEquipment> EquipmentClass)
+{
+	auto& Change{ Changes.AddDefaulted_GetRef() };
+	Change.Type = EEquipmentChangeType::Add;
+	Change.SlotTag = SlotTag;
+	Change.ItemData = ItemData;
+	Change.bEquipImmediately = bEquipImmediately;
+	Change.ResolveContext = ResolveContext;
+	Change.EquipmentClass = EquipmentClass;
+}
+
+
+void FEquipmentChangeSet::RemoveEquipmentItem(const FGameplayTag& SlotTag)
+{
+	auto& Change{ Changes.AddDefaulted_GetRef() };
+	Change.Type = EEquipmentChangeType::Remove;
+	Change.SlotTag = SlotTag;
+}
+
+void FEquipmentChangeSet::RemoveEquipmentItem(const FActiveEquipmentHandle& Handle)
+{
+	auto& Change{ Changes.AddDefaulted_GetRef() };
+	Change.Type = EEquipmentChangeType::Remove;
+	Change.Handle = Handle;
+}
+
+void FEquipmentChangeSet::RemoveAllEquipmentItem()
+{
+	auto& Change{ Changes.AddDefaulted_GetRef() };
+	Change.Type = EEquipmentChangeType::RemoveAll;
+}
+
+
+void FEquipmentChangeSet::EquipEquipment(const FGameplayTag& SlotTag)
+{
+	auto& Change{ Changes.AddDefaulted_GetRef() };
+	Change.Type = EEquipmentChangeType::Equip;
+	Change.SlotTag = SlotTag;
+}
+
+void FEquipmentChangeSet::EquipEquipment(const FActiveEquipmentHandle& Handle)
+{
+	auto& Change{ Changes.AddDefaulted_GetRef() };
+	Change.Type = EEquipmentChangeType::Equip;
+	Change.Handle = Handle;
+}
+
+
+void FEquipmentChangeSet::UnequipEquipment(const FGameplayTag& SlotTag)
+{
+	auto& Change{ Changes.AddDefaulted_GetRef() };
+	Change.Type = EEquipmentChangeType::Unequip;
+	Change.SlotTag = SlotTag;
+}
+
+void FEquipmentChangeSet::UnequipEquipment(const FActiveEquipmentHandle& Handle)
+{
+	auto& Change{ Changes.AddDefaulted_GetRef() };
+	Change.Type = EEquipmentChangeType::Unequip;
+	Change.Handle = Handle;
+}
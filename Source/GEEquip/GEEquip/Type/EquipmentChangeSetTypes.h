@@ -0,0 +1,107 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Equipment/ActiveEquipmentHandle.h"
+
+#include "GameplayTagContainer.h"
+
+#include "EquipmentChangeSetTypes.generated.h"
+
+class UItemData;
+class UEquipment;
+
+
+/**
+ * Type of change recorded in the equipment change set
+ */
+UENUM(BlueprintType)
+enum class EEquipmentChangeType : uint8
+{
+	Add,
+	Remove,
+	RemoveAll,
+	Equip,
+	Unequip
+};
+
+
+/**
+ * Single change recorded in the equipment change set
+ */
+USTRUCT(BlueprintType)
+struct GEEQUIP_API FEquipmentChange
+{
+	GENERATED_BODY()
+public:
+	FEquipmentChange() {}
+
+public:
+	UPROPERTY()
+	EEquipmentChangeType Type{ EEquipmentChangeType::Add };
+
+	UPROPERTY()
+	FGameplayTag SlotTag;
+
+	UPROPERTY()
+	FActiveEquipmentHandle Handle;
+
+	UPROPERTY()
+	TObjectPtr<const UItemData> ItemData{ nullptr };
+
+	UPROPERTY()
+	bool bEquipImmediately{ false };
+
+	//
+	// Context key used to resolve the Equipment class, e.g. the skin id
+	//
+	UPROPERTY()
+	FName ResolveContext{ NAME_None };
+
+	//
+	// Equipment class already resolved and loaded by the caller, e.g. by AddEquipmentItemAsync()
+	//
+	UPROPERTY()
+	TSubclassOf<UEquipment> EquipmentClass{ nullptr };
+
+};
+
+
+/**
+ * List of equipment changes to be applied collectively to the EquipmentManagerComponent
+ *
+ * Tips:
+ *	Changes are applied in the order they were recorded.
+ *	Equip and unequip are resolved to the final equipped entry, so only the last one fires events.
+ */
+USTRUCT(BlueprintType)
+struct GEEQUIP_API FEquipmentChangeSet
+{
+	GENERATED_BODY()
+public:
+	FEquipmentChangeSet() {}
+
+protected:
+	UPROPERTY()
+	TArray<FEquipmentChange> Changes;
+
+public:
+	void AddEquipmentItem(const FGameplayTag& SlotTag, const UItemData* ItemData, bool bEquipImmediately = false, FName ResolveContext = NAME_None, TSubclassOf<UEquipment> EquipmentClass = nullptr);
+
+	void RemoveEquipmentItem(const FGameplayTag& SlotTag);
+	void RemoveEquipmentItem(const FActiveEquipmentHandle& Handle);
+	void RemoveAllEquipmentItem();
+
+	void EquipEquipment(const FGameplayTag& SlotTag);
+	void EquipEquipment(const FActiveEquipmentHandle& Handle);
+
+	void UnequipEquipment(const FGameplayTag& SlotTag);
+	void UnequipEquipment(const FActiveEquipmentHandle& Handle);
+
+	void Reset() { Changes.Reset(); }
+
+public:
+	const TArray<FEquipmentChange>& GetChanges() const { return Changes; }
+	bool IsEmpty() const { return Changes.IsEmpty(); }
+
+};
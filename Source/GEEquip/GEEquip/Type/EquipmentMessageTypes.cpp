@@ -3,3 +3,83 @@
 #include "EquipmentMessageTypes.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentMessageTypes)
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// FEquipmentSlotListeners
+
+FDelegateHandle FEquipmentSlotListeners::Add(const FGameplayTag& SlotTag, FEquipmentSlotNativeEventDelegate::FDelegate&& Delegate, bool bIncludeChildSlots)
+{
+	if (!SlotTag.IsValid())
+	{
+		return FDelegateHandle();
+	}
+
+	auto& Listeners{ bIncludeChildSlots ? SlotAndChildListeners : SlotListeners };
+
+	auto* Found{ Listeners.Find(SlotTag) };
+
+	if (!Found)
+	{
+		Found = &Listeners.Add(SlotTag, MakeShared<FEquipmentSlotNativeEventDelegate>());
+	}
+
+	return (*Found)->Add(MoveTemp(Delegate));
+}
+
+void FEquipmentSlotListeners::Remove(const FGameplayTag& SlotTag, FDelegateHandle Handle)
+{
+	for (auto* Listeners : { &SlotListeners, &SlotAndChildListeners })
+	{
+		if (const auto* Found{ Listeners->Find(SlotTag) })
+		{
+			(*Found)->Remove(Handle);
+
+			if (!(*Found)->IsBound())
+			{
+				Listeners->Remove(SlotTag);
+			}
+		}
+	}
+}
+
+void FEquipmentSlotListeners::RemoveAll(const void* UserObject)
+{
+	for (auto* Listeners : { &SlotListeners, &SlotAndChildListeners })
+	{
+		for (auto It{ Listeners->CreateIterator() }; It; ++It)
+		{
+			It->Value->RemoveAll(UserObject);
+
+			if (!It->Value->IsBound())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void FEquipmentSlotListeners::Broadcast(const FEquipmentSlotChangedNativeMessage& Message) const
+{
+	// Keep a reference to each list so that listeners can modify the maps while broadcasting
+
+	if (const auto* Found{ SlotListeners.Find(Message.SlotTag) })
+	{
+		const auto Delegate{ *Found };
+		Delegate->Broadcast(Message);
+	}
+
+	// Walk up the parents of the slot to find the listeners of the slot and its child slots
+
+	if (!SlotAndChildListeners.IsEmpty())
+	{
+		for (auto Tag{ Message.SlotTag }; Tag.IsValid(); Tag = Tag.RequestDirectParent())
+		{
+			if (const auto* Found{ SlotAndChildListeners.Find(Tag) })
+			{
+				const auto Delegate{ *Found };
+				Delegate->Broadcast(Message);
+			}
+		}
+	}
+}
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "Equipment/ActiveEquipmentHandle.h"
+
 #include "GameplayTagContainer.h"
 
 #include "EquipmentMessageTypes.generated.h"
@@ -35,3 +37,84 @@ public:
 	TWeakObjectPtr<UEquipment> Instance{ nullptr };
 
 };
+
+
+/**
+ * Lightweight message for native listeners when Equipment registered in EquipmentManagerComponent is changed.
+ * 
+ * Tips:
+ *	Pointers are only guaranteed to be valid during the call, so do not store them.
+ */
+struct GEEQUIP_API FEquipmentSlotChangedNativeMessage
+{
+public:
+	FEquipmentSlotChangedNativeMessage() {}
+
+public:
+	UEquipmentManagerComponent* OwnerComponent{ nullptr };
+
+	//
+	// Handle of the entry in the slot (invalid if the slot is empty)
+	//
+	FActiveEquipmentHandle Handle;
+
+	FGameplayTag SlotTag{ FGameplayTag::EmptyTag };
+
+	//
+	// Index of the slot in the slot layout (INDEX_NONE if the component has no layout)
+	//
+	int32 SlotIndex{ INDEX_NONE };
+
+	const UItemData* Data{ nullptr };
+
+	UEquipment* Instance{ nullptr };
+
+};
+
+
+/**
+ * Delegate to notify changes in EquipmentSlot
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FEquipmentSlotEventDelegate, FEquipmentSlotChangedMessage, Param);
+DECLARE_MULTICAST_DELEGATE_OneParam(FEquipmentSlotNativeEventDelegate, const FEquipmentSlotChangedNativeMessage& /*Message*/);
+
+
+/**
+ * Lists of native listeners for each slot to dispatch slot events only to the matching listeners
+ * 
+ * Tips:
+ *	Listeners can be added and removed while broadcasting.
+ */
+struct GEEQUIP_API FEquipmentSlotListeners
+{
+public:
+	FEquipmentSlotListeners() {}
+
+private:
+	//
+	// Listeners of exactly the slot
+	//
+	TMap<FGameplayTag, TSharedRef<FEquipmentSlotNativeEventDelegate>> SlotListeners;
+
+	//
+	// Listeners of the slot and its child slots
+	//
+	TMap<FGameplayTag, TSharedRef<FEquipmentSlotNativeEventDelegate>> SlotAndChildListeners;
+
+public:
+	/**
+	 * Add a listener of the slot, or of the slot and its child slots if bIncludeChildSlots is true
+	 */
+	FDelegateHandle Add(const FGameplayTag& SlotTag, FEquipmentSlotNativeEventDelegate::FDelegate&& Delegate, bool bIncludeChildSlots = false);
+
+	void Remove(const FGameplayTag& SlotTag, FDelegateHandle Handle);
+	void RemoveAll(const void* UserObject);
+
+	bool IsEmpty() const { return SlotListeners.IsEmpty() && SlotAndChildListeners.IsEmpty(); }
+
+	/**
+	 * Call only the listeners whose slot matches the slot of the message
+	 */
+	void Broadcast(const FEquipmentSlotChangedNativeMessage& Message) const;
+
+};
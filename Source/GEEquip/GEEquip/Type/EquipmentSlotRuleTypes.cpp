@@ -0,0 +1,31 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "EquipmentSlotRuleTypes.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentSlotRuleTypes)
+
+
+void FEquipmentSlotRuleMasks::Build(const FGameplayTag& SlotTag, const FEquipmentSlotRules* ItemRules, const FEquipmentSlotRules* SlotRules)
+{
+	auto& Registry{ FEquipmentSlotIndexRegistry::Get() };
+
+	SlotMask = Registry.MakeSlotMask(SlotTag);
+	RemoveMask.Reset();
+	UnequipMask.Reset();
+	RequiredMask.Reset();
+
+	for (const auto* Rules : { ItemRules, SlotRules })
+	{
+		if (!Rules || Rules->IsEmpty())
+		{
+			continue;
+		}
+
+		// Blocked slots are compiled without parents so that blocking a slot also blocks its child slots
+
+		auto& BlockedMask{ (Rules->ConflictPolicy == EEquipmentSlotConflictPolicy::Remove) ? RemoveMask : UnequipMask };
+		BlockedMask.Append(Registry.MakeSlotMask(Rules->BlockedSlots, false));
+
+		RequiredMask.Append(Registry.MakeSlotMask(Rules->RequiredSlots, false));
+	}
+}
@@ -0,0 +1,118 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Type/EquipmentSlotTypes.h"
+
+#include "GameplayTagContainer.h"
+
+#include "EquipmentSlotRuleTypes.generated.h"
+
+
+/**
+ * How entries in the slots blocked by slot rules are resolved
+ */
+UENUM(BlueprintType)
+enum class EEquipmentSlotConflictPolicy : uint8
+{
+	// Entries in the blocked slots are removed when this is added, e.g. two-handed weapon and off-hand slot
+	Remove,
+
+	// Entries in the blocked slots are kept but unequipped when this is equipped
+	Unequip
+};
+
+
+/**
+ * Declarative rules on which slots can be occupied together
+ */
+USTRUCT(BlueprintType)
+struct GEEQUIP_API FEquipmentSlotRules
+{
+	GENERATED_BODY()
+public:
+	FEquipmentSlotRules() {}
+
+public:
+	//
+	// Slots (and their child slots) that cannot be used together with this
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rules", meta = (Categories = "Equipment.Slot"))
+	FGameplayTagContainer BlockedSlots;
+
+	//
+	// How entries in BlockedSlots are resolved
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rules")
+	EEquipmentSlotConflictPolicy ConflictPolicy{ EEquipmentSlotConflictPolicy::Remove };
+
+	//
+	// Slots that must be occupied to add this.
+	// 
+	// Tips:
+	//	This is removed automatically when any of the required slots is no longer occupied.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rules", meta = (Categories = "Equipment.Slot"))
+	FGameplayTagContainer RequiredSlots;
+
+public:
+	bool IsEmpty() const { return BlockedSlots.IsEmpty() && RequiredSlots.IsEmpty(); }
+
+};
+
+
+/**
+ * Slot rules of an entry compiled into bit masks by FEquipmentSlotIndexRegistry
+ * 
+ * Tips:
+ *	The masks must be rebuilt when the serial of the registry changes.
+ */
+struct GEEQUIP_API FEquipmentSlotRuleMasks
+{
+public:
+	FEquipmentSlotRuleMasks() {}
+
+public:
+	//
+	// Slot of the entry and all its parents
+	//
+	FEquipmentSlotMask SlotMask;
+
+	//
+	// Slots blocked with the Remove policy
+	//
+	FEquipmentSlotMask RemoveMask;
+
+	//
+	// Slots blocked with the Unequip policy
+	//
+	FEquipmentSlotMask UnequipMask;
+
+	//
+	// Slots that must be occupied
+	//
+	FEquipmentSlotMask RequiredMask;
+
+public:
+	/**
+	 * Build the masks from the rules of the item and the rules of the slot
+	 */
+	void Build(const FGameplayTag& SlotTag, const FEquipmentSlotRules* ItemRules, const FEquipmentSlotRules* SlotRules);
+
+	/**
+	 * Returns whether either entry must be removed when the other is added
+	 */
+	bool RemovesOnAdd(const FEquipmentSlotRuleMasks& Other) const
+	{
+		return RemoveMask.Intersects(Other.SlotMask) || Other.RemoveMask.Intersects(SlotMask);
+	}
+
+	/**
+	 * Returns whether either entry must be unequipped when the other is equipped
+	 */
+	bool UnequipsOnEquip(const FEquipmentSlotRuleMasks& Other) const
+	{
+		return UnequipMask.Intersects(Other.SlotMask) || Other.UnequipMask.Intersects(SlotMask);
+	}
+
+};
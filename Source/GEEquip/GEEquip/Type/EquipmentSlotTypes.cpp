@@ -0,0 +1,273 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "EquipmentSlotTypes.h"
+
+#include "GameplayTag/GEEquipTags_Equipment.h"
+
+#include "GameplayTagsManager.h"
+#include "GameplayTagsModule.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// FEquipmentSlotMask
+
+void FEquipmentSlotMask::SetBit(int32 Index)
+{
+	check(Index >= 0);
+
+	const auto WordIndex{ Index / 64 };
+
+	if (WordIndex >= Words.Num())
+	{
+		Words.SetNumZeroed(WordIndex + 1);
+	}
+
+	Words[WordIndex] |= (1ull << (Index % 64));
+}
+
+void FEquipmentSlotMask::ClearBit(int32 Index)
+{
+	const auto WordIndex{ Index / 64 };
+
+	if (Words.IsValidIndex(WordIndex))
+	{
+		Words[WordIndex] &= ~(1ull << (Index % 64));
+	}
+}
+
+bool FEquipmentSlotMask::HasBit(int32 Index) const
+{
+	const auto WordIndex{ Index / 64 };
+
+	return Words.IsValidIndex(WordIndex) && ((Words[WordIndex] & (1ull << (Index % 64))) != 0);
+}
+
+void FEquipmentSlotMask::Append(const FEquipmentSlotMask& Other)
+{
+	if (Other.Words.Num() > Words.Num())
+	{
+		Words.SetNumZeroed(Other.Words.Num());
+	}
+
+	for (auto WordIndex{ 0 }; WordIndex < Other.Words.Num(); ++WordIndex)
+	{
+		Words[WordIndex] |= Other.Words[WordIndex];
+	}
+}
+
+bool FEquipmentSlotMask::Intersects(const FEquipmentSlotMask& Other) const
+{
+	const auto NumWords{ FMath::Min(Words.Num(), Other.Words.Num()) };
+
+	for (auto WordIndex{ 0 }; WordIndex < NumWords; ++WordIndex)
+	{
+		if ((Words[WordIndex] & Other.Words[WordIndex]) != 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FEquipmentSlotMask::Contains(const FEquipmentSlotMask& Other) const
+{
+	for (auto WordIndex{ 0 }; WordIndex < Other.Words.Num(); ++WordIndex)
+	{
+		const auto Word{ Words.IsValidIndex(WordIndex) ? Words[WordIndex] : 0ull };
+
+		if ((Word & Other.Words[WordIndex]) != Other.Words[WordIndex])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FEquipmentSlotMask::IsEmpty() const
+{
+	for (const auto& Word : Words)
+	{
+		if (Word != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// FEquipmentSlotIndexRegistry
+
+FEquipmentSlotIndexRegistry& FEquipmentSlotIndexRegistry::Get()
+{
+	static FEquipmentSlotIndexRegistry Instance;
+	return Instance;
+}
+
+FEquipmentSlotIndexRegistry::FEquipmentSlotIndexRegistry()
+{
+}
+
+
+void FEquipmentSlotIndexRegistry::Startup()
+{
+	// Reassign indices when tags are added at runtime, e.g. by game feature plugins
+
+	if (!TagTreeChangedHandle.IsValid())
+	{
+		TagTreeChangedHandle = IGameplayTagsModule::OnGameplayTagTreeChanged.AddRaw(this, &FEquipmentSlotIndexRegistry::MarkDirty);
+	}
+
+	bDirty = true;
+}
+
+void FEquipmentSlotIndexRegistry::Shutdown()
+{
+	IGameplayTagsModule::OnGameplayTagTreeChanged.Remove(TagTreeChangedHandle);
+	TagTreeChangedHandle.Reset();
+}
+
+
+void FEquipmentSlotIndexRegistry::Rebuild()
+{
+	check(IsInGameThread());
+
+	bDirty = false;
+	Serial = (Serial == MAX_uint32) ? 1 : (Serial + 1);
+
+	SlotTags.Reset();
+	SlotToIndex.Reset();
+	SlotAndParentMasks.Reset();
+
+	// Assign indices in name order so that they are stable across processes with the same tags
+
+	const auto& TagManager{ UGameplayTagsManager::Get() };
+
+	SlotTags.Add(TAG_Equipment_Slot);
+	TagManager.RequestGameplayTagChildren(TAG_Equipment_Slot).GetGameplayTagArray(SlotTags);
+
+	SlotTags.Sort([](const FGameplayTag& A, const FGameplayTag& B) { return A.GetTagName().LexicalLess(B.GetTagName()); });
+
+	for (auto It{ SlotTags.CreateConstIterator() }; It; ++It)
+	{
+		SlotToIndex.Add(*It, It.GetIndex());
+	}
+
+	// Build masks including parents
+
+	SlotAndParentMasks.SetNum(SlotTags.Num());
+
+	for (auto It{ SlotTags.CreateConstIterator() }; It; ++It)
+	{
+		auto& Mask{ SlotAndParentMasks[It.GetIndex()] };
+
+		for (const auto& Tag : It->GetGameplayTagParents())
+		{
+			if (const auto* Index{ SlotToIndex.Find(Tag) })
+			{
+				Mask.SetBit(*Index);
+			}
+		}
+	}
+}
+
+
+int32 FEquipmentSlotIndexRegistry::GetSlotIndex(const FGameplayTag& SlotTag)
+{
+	ConditionalRebuild();
+
+	const auto* Index{ SlotToIndex.Find(SlotTag) };
+
+	return Index ? *Index : INDEX_NONE;
+}
+
+FGameplayTag FEquipmentSlotIndexRegistry::GetSlotTag(int32 Index)
+{
+	ConditionalRebuild();
+
+	return SlotTags.IsValidIndex(Index) ? SlotTags[Index] : FGameplayTag::EmptyTag;
+}
+
+int32 FEquipmentSlotIndexRegistry::GetNumSlots()
+{
+	ConditionalRebuild();
+
+	return SlotTags.Num();
+}
+
+uint32 FEquipmentSlotIndexRegistry::GetSerial()
+{
+	ConditionalRebuild();
+
+	return Serial;
+}
+
+FEquipmentSlotMask FEquipmentSlotIndexRegistry::MakeSlotMask(const FGameplayTagContainer& Slots, bool bIncludeParents)
+{
+	ConditionalRebuild();
+
+	FEquipmentSlotMask Result;
+
+	for (const auto& Tag : Slots)
+	{
+		if (const auto* Index{ SlotToIndex.Find(Tag) })
+		{
+			if (bIncludeParents)
+			{
+				Result.Append(SlotAndParentMasks[*Index]);
+			}
+			else
+			{
+				Result.SetBit(*Index);
+			}
+		}
+	}
+
+	return Result;
+}
+
+FEquipmentSlotMask FEquipmentSlotIndexRegistry::MakeSlotMask(const FGameplayTag& SlotTag)
+{
+	ConditionalRebuild();
+
+	const auto* Index{ SlotToIndex.Find(SlotTag) };
+
+	return Index ? SlotAndParentMasks[*Index] : FEquipmentSlotMask();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// FEquipmentSlotMaskCache
+
+void FEquipmentSlotMaskCache::Update(const FGameplayTagContainer& Slots)
+{
+	auto& Registry{ FEquipmentSlotIndexRegistry::Get() };
+
+	const auto CurrentSerial{ Registry.GetSerial() };
+
+	if (Serial != CurrentSerial)
+	{
+		Mask = Registry.MakeSlotMask(Slots);
+		Serial = CurrentSerial;
+	}
+}
+
+bool FEquipmentSlotMaskCache::HasSlot(const FGameplayTagContainer& Slots, const FGameplayTag& SlotTag)
+{
+	const auto Index{ FEquipmentSlotIndexRegistry::Get().GetSlotIndex(SlotTag) };
+
+	// Fall back to the tag query for tags outside of the slot hierarchy
+
+	if (Index == INDEX_NONE)
+	{
+		return Slots.HasTag(SlotTag);
+	}
+
+	Update(Slots);
+
+	return Mask.HasBit(Index);
+}
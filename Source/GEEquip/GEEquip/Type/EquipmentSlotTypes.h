@@ -0,0 +1,165 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+
+
+/**
+ * Bit set of equipment slots indexed by FEquipmentSlotIndexRegistry
+ */
+struct GEEQUIP_API FEquipmentSlotMask
+{
+public:
+	FEquipmentSlotMask() {}
+
+private:
+	TArray<uint64, TInlineAllocator<2>> Words;
+
+public:
+	void SetBit(int32 Index);
+	void ClearBit(int32 Index);
+	bool HasBit(int32 Index) const;
+
+	/**
+	 * Set all bits set in the other mask
+	 */
+	void Append(const FEquipmentSlotMask& Other);
+
+	/**
+	 * Returns whether any bit is set in both masks
+	 */
+	bool Intersects(const FEquipmentSlotMask& Other) const;
+
+	/**
+	 * Returns whether all bits set in the other mask are also set in this mask
+	 */
+	bool Contains(const FEquipmentSlotMask& Other) const;
+
+	bool IsEmpty() const;
+	void Reset() { Words.Reset(); }
+
+};
+
+
+/**
+ * Registry that assigns a dense index to each slot tag under TAG_Equipment_Slot
+ * 
+ * Tips:
+ *	Indices are assigned in tag name order and reassigned when the gameplay tag tree changes,
+ *	so they must not be saved or replicated. Use GetSerial() to detect reassignment.
+ *	Must be used from the game thread. The tag tree change binding is owned by the GEEquip module.
+ */
+class GEEQUIP_API FEquipmentSlotIndexRegistry
+{
+public:
+	static FEquipmentSlotIndexRegistry& Get();
+
+private:
+	FEquipmentSlotIndexRegistry();
+
+private:
+	//
+	// Slot tag of each index
+	//
+	TArray<FGameplayTag> SlotTags;
+
+	//
+	// Index of each slot tag
+	//
+	TMap<FGameplayTag, int32> SlotToIndex;
+
+	//
+	// Mask of the slot and all its parent slots for each index
+	//
+	TArray<FEquipmentSlotMask> SlotAndParentMasks;
+
+	//
+	// Incremented each time the indices are reassigned (0 means never built)
+	//
+	uint32 Serial{ 0 };
+
+	bool bDirty{ true };
+
+	//
+	// Handle bound to IGameplayTagsModule::OnGameplayTagTreeChanged
+	//
+	FDelegateHandle TagTreeChangedHandle;
+
+	void Rebuild();
+	void ConditionalRebuild() { if (bDirty) { Rebuild(); } }
+	void MarkDirty() { bDirty = true; }
+
+public:
+	/**
+	 * Start reassigning indices when the gameplay tag tree changes
+	 * 
+	 * Note:
+	 *	Called from FGEEquipModule::StartupModule() and paired with Shutdown().
+	 */
+	void Startup();
+
+	/**
+	 * Stop listening to the gameplay tag tree so that no delegate outlives the module
+	 */
+	void Shutdown();
+
+	/**
+	 * Returns the dense index of the slot or INDEX_NONE if it is not under TAG_Equipment_Slot
+	 */
+	int32 GetSlotIndex(const FGameplayTag& SlotTag);
+
+	/**
+	 * Returns the slot tag of the index
+	 */
+	FGameplayTag GetSlotTag(int32 Index);
+
+	int32 GetNumSlots();
+	uint32 GetSerial();
+
+	/**
+	 * Make a mask of the slots and all their parent slots so that bit tests match FGameplayTagContainer::HasTag()
+	 * 
+	 * Tips:
+	 *	If bIncludeParents is false, only the bits of the slots themselves are set.
+	 */
+	FEquipmentSlotMask MakeSlotMask(const FGameplayTagContainer& Slots, bool bIncludeParents = true);
+
+	/**
+	 * Returns the mask of the slot and all its parent slots or empty mask if it is not under TAG_Equipment_Slot
+	 */
+	FEquipmentSlotMask MakeSlotMask(const FGameplayTag& SlotTag);
+
+};
+
+
+/**
+ * Slot mask built lazily from a tag container and rebuilt when the slot indices are reassigned
+ */
+struct GEEQUIP_API FEquipmentSlotMaskCache
+{
+public:
+	FEquipmentSlotMaskCache() {}
+
+private:
+	FEquipmentSlotMask Mask;
+
+	uint32 Serial{ 0 };
+
+public:
+	/**
+	 * Build the mask from the slots if the slot indices were reassigned
+	 */
+	void Update(const FGameplayTagContainer& Slots);
+
+	/**
+	 * Discard the mask so that it is rebuilt on next use
+	 */
+	void Invalidate() { Serial = 0; }
+
+	/**
+	 * Returns the same result as Slots.HasTag(SlotTag) with a single bit test
+	 */
+	bool HasSlot(const FGameplayTagContainer& Slots, const FGameplayTag& SlotTag);
+
+};